@@ -0,0 +1,54 @@
+/**
+ * @file AtomicFile.cpp
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Windows implementation of atomic file writes.
+ * @bug No known bugs.
+ */
+
+#include "AtomicFile.h"
+
+#include <Windows.h>
+
+/**
+ * @brief Writes the given data to a file, replacing anything already there.
+ *
+ * The data is written to a temporary file with a single write, and then moved
+ * into place, so a partially written file is never seen.
+ *
+ * @param path The path of the file.
+ * @param data The new contents of the file.
+ * @param size The size of the new contents.
+ * @return True if the file was written.
+ */
+bool
+WriteFileAtomic(
+    const std::string &path,
+    const char *data,
+    size_t size
+) {
+    std::string tmp = path + ".tmp";
+    HANDLE f = CreateFileA(
+        tmp.c_str(),
+        GENERIC_WRITE,
+        0,
+        NULL,
+        CREATE_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL,
+        NULL
+    );
+    if (f == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    DWORD written;
+    bool ok = WriteFile(f, data, static_cast<DWORD>(size), &written, NULL)
+        && (written == size);
+    CloseHandle(f);
+
+    if (!ok || !MoveFileExA(tmp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+        DeleteFileA(tmp.c_str());
+        return false;
+    }
+
+    return true;
+}
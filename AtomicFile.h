@@ -0,0 +1,16 @@
+/**
+ * @file AtomicFile.h
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Replaces the contents of a file in a single step.
+ * @bug No known bugs.
+ */
+
+#ifndef __SKYRIM_UNCAPPER_AE_ATOMIC_FILE_H__
+#define __SKYRIM_UNCAPPER_AE_ATOMIC_FILE_H__
+
+#include <cstddef>
+#include <string>
+
+bool WriteFileAtomic(const std::string &path, const char *data, size_t size);
+
+#endif /* __SKYRIM_UNCAPPER_AE_ATOMIC_FILE_H__ */
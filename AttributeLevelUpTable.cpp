@@ -0,0 +1,194 @@
+/**
+ * @file AttributeLevelUpTable.cpp
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Implementation of the attribute level up lookup table.
+ * @bug No known bugs.
+ */
+
+#include "AttributeLevelUpTable.h"
+
+#include <algorithm>
+
+#include "Settings.h"
+#include "Compare.h"
+#include "ConfigCache.h"
+
+/**
+ * @brief Converts an attribute choice to its index in the table.
+ */
+size_t
+AttributeLevelUpTable::ChoiceIndex(
+    ActorAttribute::t choice
+) {
+    size_t ret = 0;
+
+    switch (choice) {
+        case ActorAttribute::Health:
+            ret = 0;
+            break;
+        case ActorAttribute::Magicka:
+            ret = 1;
+            break;
+        case ActorAttribute::Stamina:
+            ret = 2;
+            break;
+        default:
+            HALT("Cannot get attribute level up with an invalid choice.");
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Looks up the gains for each choice at the given level.
+ * @param src The leveled settings to look the gains up in.
+ * @param level The level to get the gains for.
+ * @param gains Returns the gains for each choice.
+ */
+void
+AttributeLevelUpTable::Fill(
+    Sources &src,
+    unsigned int level,
+    ActorAttributeLevelUp gains[kChoiceCount]
+) {
+    for (size_t c = 0; c < kChoiceCount; c++) {
+        gains[c] = {
+            static_cast<float>(src[c][0]->Get(level)),
+            static_cast<float>(src[c][1]->Get(level)),
+            static_cast<float>(src[c][2]->Get(level)),
+            static_cast<float>(src[c][3]->Get(level))
+        };
+    }
+}
+
+/**
+ * @brief Checks if two levels give the same gains for every choice.
+ */
+bool
+AttributeLevelUpTable::SameGains(
+    const ActorAttributeLevelUp a[kChoiceCount],
+    const ActorAttributeLevelUp b[kChoiceCount]
+) {
+    for (size_t c = 0; c < kChoiceCount; c++) {
+        if ((a[c].health != b[c].health) || (a[c].magicka != b[c].magicka)
+                || (a[c].stamina != b[c].stamina) || (a[c].carry_weight != b[c].carry_weight)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Compiles the given leveled settings into the lookup table.
+ *
+ * Past the dense table, an interpolated setting may change the gains at
+ * every level until its last entry, so each change starts a run. Those runs
+ * are only kept up to the highest level the player can reach.
+ *
+ * @param src The settings to compile, which must have already been read.
+ */
+void
+AttributeLevelUpTable::Compile(
+    Sources &src
+) {
+    dense.clear();
+    runs.clear();
+
+    // Every configured level of every setting may start a new run.
+    std::vector<unsigned int> levels;
+    unsigned int blend_end = 0;
+    for (size_t c = 0; c < kChoiceCount; c++) {
+        for (size_t g = 0; g < kGainCount; g++) {
+            for (size_t i = 0; i < src[c][g]->Size(); i++) {
+                levels.push_back(src[c][g]->LevelAt(i));
+            }
+            blend_end = MAX(blend_end, src[c][g]->BlendEnd());
+        }
+    }
+    blend_end = MIN(blend_end, static_cast<unsigned int>(MAX_PLAYER_LEVEL) + 1);
+    std::sort(levels.begin(), levels.end());
+    levels.erase(std::unique(levels.begin(), levels.end()), levels.end());
+    ASSERT(!levels.empty() && (levels.front() == 0));
+
+    size_t dense_levels = MIN(kMaxDenseLevels, static_cast<size_t>(levels.back()) + 1);
+    dense.resize(dense_levels * kChoiceCount);
+    for (size_t level = 0; level < dense_levels; level++) {
+        Fill(src, static_cast<unsigned int>(level), &dense[level * kChoiceCount]);
+    }
+
+    // The first run picks up where the dense table ends, so any level past it
+    // always has a run.
+    runs.push_back({ static_cast<unsigned int>(dense_levels), {} });
+    Fill(src, runs.back().level, runs.back().gains);
+    auto add = [&](unsigned int level) {
+        Run run = { level, {} };
+        Fill(src, level, run.gains);
+        if (!SameGains(run.gains, runs.back().gains)) {
+            runs.push_back(run);
+        }
+    };
+
+    for (unsigned int level = runs[0].level + 1; level < blend_end; level++) {
+        add(level);
+    }
+
+    auto first = std::lower_bound(levels.begin(), levels.end(), MAX(runs[0].level + 1, blend_end));
+    for (auto level = first; level != levels.end(); level++) {
+        add(*level);
+    }
+}
+
+/**
+ * @brief Writes the compiled table to the settings cache.
+ */
+void
+AttributeLevelUpTable::SaveCache(
+    CacheWriter &cache
+) {
+    cache.Write(dense);
+    cache.Write(runs);
+}
+
+/**
+ * @brief Reads the compiled table from the settings cache.
+ * @return True if a valid table was read.
+ */
+bool
+AttributeLevelUpTable::LoadCache(
+    CacheReader &cache
+) {
+    return cache.Read(dense) && cache.Read(runs)
+        && !dense.empty() && !(dense.size() % kChoiceCount)
+        && !runs.empty() && (runs[0].level == (dense.size() / kChoiceCount));
+}
+
+/**
+ * @brief Gets the attribute gains from the given player level and selection.
+ * @param level The level of the player.
+ * @param choice The attribute the player selected to level.
+ * @return The gains for each attribute for this level up.
+ */
+const ActorAttributeLevelUp &
+AttributeLevelUpTable::Get(
+    unsigned int level,
+    ActorAttribute::t choice
+) {
+    ASSERT(!dense.empty());
+    size_t c = ChoiceIndex(choice);
+
+    if (level < (dense.size() / kChoiceCount)) {
+        return dense[level * kChoiceCount + c];
+    }
+
+    auto run = std::upper_bound(
+        runs.begin(),
+        runs.end(),
+        level,
+        [](unsigned int l, const Run &r) { return l < r.level; }
+    );
+    ASSERT(run != runs.begin());
+    run--;
+
+    return run->gains[c];
+}
@@ -0,0 +1,66 @@
+/**
+ * @file AttributeLevelUpTable.h
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Compiles the leveled attribute settings into a single lookup table.
+ * @bug No known bugs.
+ */
+
+#ifndef __SKYRIM_UNCAPPER_AE_ATTRIBUTE_LEVEL_UP_TABLE_H__
+#define __SKYRIM_UNCAPPER_AE_ATTRIBUTE_LEVEL_UP_TABLE_H__
+
+#include <vector>
+
+#include "ActorAttribute.h"
+
+template <typename T> class LeveledSetting;
+class CacheWriter;
+class CacheReader;
+
+/**
+ * @brief Holds the attribute gains for every level and player choice.
+ *
+ * Levels up to the last configured level (within a limit) are stored densely.
+ * Anything above that is stored as runs of levels which share the same gains.
+ */
+class AttributeLevelUpTable {
+  public:
+    /// @brief The number of attributes the player can choose from.
+    static const size_t kChoiceCount = 3;
+
+    /// @brief The number of attributes which change at each level up.
+    static const size_t kGainCount = 4;
+
+    /**
+     * @brief The settings to compile, indexed by player choice and then by
+     *        health, magicka, stamina and carry weight.
+     */
+    typedef LeveledSetting<unsigned int> *const Sources[kChoiceCount][kGainCount];
+
+  private:
+    /// @brief The maximum number of levels stored in the dense table.
+    static const size_t kMaxDenseLevels = 4096;
+
+    /// @brief Levels at or above a run level use that run.
+    struct Run {
+        unsigned int level;
+        ActorAttributeLevelUp gains[kChoiceCount];
+    };
+
+    /// @brief Indexed by level * kChoiceCount + choice.
+    std::vector<ActorAttributeLevelUp> dense;
+    std::vector<Run> runs;
+
+    static size_t ChoiceIndex(ActorAttribute::t choice);
+    static void Fill(Sources &src, unsigned int level,
+                     ActorAttributeLevelUp gains[kChoiceCount]);
+    static bool SameGains(const ActorAttributeLevelUp a[kChoiceCount],
+                          const ActorAttributeLevelUp b[kChoiceCount]);
+
+  public:
+    void Compile(Sources &src);
+    void SaveCache(CacheWriter &cache);
+    bool LoadCache(CacheReader &cache);
+    const ActorAttributeLevelUp &Get(unsigned int level, ActorAttribute::t choice);
+};
+
+#endif /* __SKYRIM_UNCAPPER_AE_ATTRIBUTE_LEVEL_UP_TABLE_H__ */
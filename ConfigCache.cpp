@@ -0,0 +1,117 @@
+/**
+ * @file ConfigCache.cpp
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Implementation of the compiled settings cache file.
+ * @bug No known bugs.
+ */
+
+#include "ConfigCache.h"
+
+#include "AtomicFile.h"
+
+/// @brief Identifies a cache file.
+static const char kCacheMagic[4] = { 'S', 'U', 'C', 'C' };
+
+/**
+ * @brief The header at the start of a cache file, followed by the payload.
+ */
+struct CacheHeader {
+    char magic[4];
+    uint32_t reserved;
+    ConfigCacheKey key;
+    uint64_t payloadSize;
+    uint64_t payloadHash;
+};
+
+/**
+ * @brief Hashes the given data with 64-bit FNV-1a.
+ */
+uint64_t
+HashConfigData(
+    const char *data,
+    size_t size
+) {
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; i++) {
+        h = (h ^ static_cast<unsigned char>(data[i])) * 1099511628211ULL;
+    }
+
+    return h;
+}
+
+/**
+ * @brief Creates an empty cache, leaving room for the header.
+ */
+CacheWriter::CacheWriter(
+) : payload(sizeof(CacheHeader))
+{}
+
+/**
+ * @brief Writes the cache to the given path.
+ *
+ * The cache is replaced in a single step, so a partially written cache is
+ * never seen.
+ *
+ * @param path The path of the cache file.
+ * @param key The key of the INI file the cache was built from.
+ * @return True if the cache was saved.
+ */
+bool
+CacheWriter::Save(
+    const std::string &path,
+    const ConfigCacheKey &key
+) {
+    const char *body = payload.data() + sizeof(CacheHeader);
+    size_t body_size = payload.size() - sizeof(CacheHeader);
+
+    CacheHeader header = {};
+    memcpy(header.magic, kCacheMagic, sizeof(kCacheMagic));
+    header.key = key;
+    header.payloadSize = body_size;
+    header.payloadHash = HashConfigData(body, body_size);
+    memcpy(payload.data(), &header, sizeof(header));
+
+    return WriteFileAtomic(path, payload.data(), payload.size());
+}
+
+/**
+ * @brief Opens the cache at the given path for reading.
+ *
+ * The cache is rejected if it is missing, truncated, corrupt, or was built
+ * from a different INI file or plugin version.
+ *
+ * @param path The path of the cache file.
+ * @param key The key of the INI file being loaded.
+ * @return True if the cache can be read.
+ */
+bool
+CacheReader::Open(
+    const std::string &path,
+    const ConfigCacheKey &key
+) {
+    pos = end = nullptr;
+    if ((file.Open(path.c_str()) != MappedFile::Ok)
+            || (file.Size() < sizeof(CacheHeader))) {
+        return false;
+    }
+
+    CacheHeader header;
+    memcpy(&header, file.Data(), sizeof(header));
+
+    const char *payload = file.Data() + sizeof(header);
+    size_t payload_size = file.Size() - sizeof(header);
+    if (memcmp(header.magic, kCacheMagic, sizeof(kCacheMagic))
+            || (header.key.size != key.size)
+            || (header.key.modified != key.modified)
+            || (header.key.hash != key.hash)
+            || (header.key.configVersion != key.configVersion)
+            || (header.key.cacheVersion != key.cacheVersion)
+            || (header.payloadSize != payload_size)
+            || (header.payloadHash != HashConfigData(payload, payload_size))) {
+        return false;
+    }
+
+    pos = payload;
+    end = payload + payload_size;
+    return true;
+}
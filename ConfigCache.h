@@ -0,0 +1,165 @@
+/**
+ * @file ConfigCache.h
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Reads and writes the compiled settings cache.
+ * @bug No known bugs.
+ */
+
+#ifndef __SKYRIM_UNCAPPER_AE_CONFIG_CACHE_H__
+#define __SKYRIM_UNCAPPER_AE_CONFIG_CACHE_H__
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <type_traits>
+
+#include "MappedFile.h"
+
+/**
+ * @brief Identifies the INI file, and the version of the plugin, which a cache
+ *        was built from. A cache is only used if its key matches exactly.
+ */
+struct ConfigCacheKey {
+    uint64_t size;
+    uint64_t modified;
+    uint64_t hash;
+    uint32_t configVersion;
+    uint32_t cacheVersion;
+};
+
+uint64_t HashConfigData(const char *data, size_t size);
+
+/**
+ * @brief Serializes the compiled settings into a cache file.
+ */
+class CacheWriter {
+  private:
+    /// @brief The header, which is filled in on save, and then the payload.
+    std::vector<char> payload;
+
+  public:
+    CacheWriter();
+
+    /// @brief Appends a plain value to the cache.
+    template <typename T>
+    void
+    Write(
+        const T &val
+    ) {
+        static_assert(std::is_trivially_copyable<T>::value, "Cache values must be plain data.");
+        const char *bytes = reinterpret_cast<const char*>(&val);
+        payload.insert(payload.end(), bytes, bytes + sizeof(T));
+    }
+
+    /// @brief Appends a string to the cache, prefixed by its length.
+    void
+    Write(
+        const std::string &str
+    ) {
+        Write(static_cast<uint32_t>(str.size()));
+        payload.insert(payload.end(), str.begin(), str.end());
+    }
+
+    /// @brief Appends a vector of plain values to the cache, prefixed by its length.
+    template <typename T>
+    void
+    Write(
+        const std::vector<T> &vec
+    ) {
+        static_assert(std::is_trivially_copyable<T>::value, "Cache values must be plain data.");
+        Write(static_cast<uint32_t>(vec.size()));
+        const char *bytes = reinterpret_cast<const char*>(vec.data());
+        payload.insert(payload.end(), bytes, bytes + vec.size() * sizeof(T));
+    }
+
+    bool Save(const std::string &path, const ConfigCacheKey &key);
+};
+
+/**
+ * @brief Deserializes the compiled settings from a cache file.
+ *
+ * Every read is bounds checked, and fails rather than reading past the end of
+ * the cache.
+ */
+class CacheReader {
+  private:
+    MappedFile file;
+    const char *pos;
+    const char *end;
+
+    /**
+     * @brief Reads the given number of bytes from the cache.
+     * @return True if there were enough bytes left.
+     */
+    bool
+    ReadBytes(
+        void *dst,
+        size_t len
+    ) {
+        if (static_cast<size_t>(end - pos) < len) {
+            return false;
+        }
+
+        // An empty vector may have no storage to copy into.
+        if (len) {
+            memcpy(dst, pos, len);
+        }
+        pos += len;
+        return true;
+    }
+
+  public:
+    CacheReader(
+    ) : pos(nullptr),
+        end(nullptr)
+    {}
+
+    bool Open(const std::string &path, const ConfigCacheKey &key);
+
+    /// @brief Reads a plain value from the cache.
+    template <typename T>
+    bool
+    Read(
+        T &val
+    ) {
+        static_assert(std::is_trivially_copyable<T>::value, "Cache values must be plain data.");
+        return ReadBytes(&val, sizeof(T));
+    }
+
+    /// @brief Reads a length prefixed string from the cache.
+    bool
+    Read(
+        std::string &str
+    ) {
+        uint32_t len;
+        if (!Read(len) || (static_cast<size_t>(end - pos) < len)) {
+            return false;
+        }
+
+        str.assign(pos, len);
+        pos += len;
+        return true;
+    }
+
+    /// @brief Reads a length prefixed vector of plain values from the cache.
+    template <typename T>
+    bool
+    Read(
+        std::vector<T> &vec
+    ) {
+        static_assert(std::is_trivially_copyable<T>::value, "Cache values must be plain data.");
+        uint32_t len;
+        if (!Read(len) || ((static_cast<size_t>(end - pos) / sizeof(T)) < len)) {
+            return false;
+        }
+
+        vec.resize(len);
+        return ReadBytes(vec.data(), len * sizeof(T));
+    }
+
+    /// @brief Checks if the whole cache has been read.
+    inline bool AtEnd(void) const { return pos == end; }
+};
+
+#endif /* __SKYRIM_UNCAPPER_AE_CONFIG_CACHE_H__ */
@@ -0,0 +1,466 @@
+/**
+ * @file Formula.cpp
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Implementation of the INI formula compiler.
+ * @bug No known bugs.
+ */
+
+#include "Formula.h"
+
+#include <cmath>
+
+#include "Ini.h"
+
+/**
+ * @brief A recursive descent parser, which emits the program of a formula as
+ *        it goes.
+ *
+ * The grammar, from lowest to highest precedence, is:
+ *
+ * expr    := term (('+' | '-') term)*
+ * term    := unary (('*' | '/') unary)*
+ * unary   := ('-' | '+') unary | power
+ * power   := primary ('^' unary)?
+ * primary := number | "level" | name '(' expr (',' expr)* ')' | '(' expr ')'
+ */
+class Formula::Parser {
+  private:
+    /// @brief A function which may be called in a formula.
+    struct Function {
+        const char *name;
+        Op op;
+    };
+
+    static const Function kFunctions[];
+
+    std::string_view text;
+    std::vector<Instr> &code;
+    size_t pos;
+
+    /// @brief The depth of the evaluation stack after the emitted code.
+    size_t depth;
+
+    /// @brief The number of expressions the parser is currently inside of.
+    size_t nesting;
+
+    bool ok;
+
+    /// @brief Stops parsing, leaving the position at the error.
+    inline void Fail(void) { ok = false; }
+
+    /// @brief Skips any white space at the current position.
+    void
+    SkipSpace() {
+        while ((pos < text.size()) && ((text[pos] == ' ') || (text[pos] == '\t'))) {
+            pos++;
+        }
+    }
+
+    /**
+     * @brief Consumes the given character, if it is next in the text.
+     * @return True if the character was consumed.
+     */
+    bool
+    Accept(
+        char c
+    ) {
+        SkipSpace();
+        if ((pos < text.size()) && (text[pos] == c)) {
+            pos++;
+            return true;
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Appends an instruction to the program.
+     *
+     * An operation whose arguments are all constants is folded into a single
+     * constant instead.
+     */
+    void
+    Emit(
+        Op op,
+        double val = 0
+    ) {
+        if (!ok) {
+            return;
+        }
+
+        int n = Arity(op);
+        if (n == 0) {
+            if (++depth > kMaxDepth) {
+                Fail();
+                return;
+            }
+
+            code.push_back({ op, val });
+            return;
+        }
+
+        ASSERT(code.size() >= static_cast<size_t>(n));
+        depth -= n - 1;
+
+        bool folds = true;
+        double args[2];
+        for (int i = 0; i < n; i++) {
+            const Instr &arg = code[code.size() - n + i];
+            folds = folds && (arg.op == Op::Const);
+            args[i] = arg.val;
+        }
+
+        if (folds) {
+            code.resize(code.size() - n);
+            code.push_back({ Op::Const, Apply(op, args) });
+        } else {
+            code.push_back({ op, 0 });
+        }
+    }
+
+    void
+    Expr() {
+        if (++nesting > kMaxDepth) {
+            Fail();
+            return;
+        }
+
+        Term();
+        while (ok) {
+            if (Accept('+')) {
+                Term();
+                Emit(Op::Add);
+            } else if (Accept('-')) {
+                Term();
+                Emit(Op::Sub);
+            } else {
+                break;
+            }
+        }
+
+        nesting--;
+    }
+
+    void
+    Term() {
+        Unary();
+        while (ok) {
+            if (Accept('*')) {
+                Unary();
+                Emit(Op::Mul);
+            } else if (Accept('/')) {
+                Unary();
+                Emit(Op::Div);
+            } else {
+                break;
+            }
+        }
+    }
+
+    void
+    Unary() {
+        if (Accept('-')) {
+            if (++nesting > kMaxDepth) {
+                Fail();
+                return;
+            }
+
+            Unary();
+            Emit(Op::Neg);
+            nesting--;
+        } else if (Accept('+')) {
+            if (++nesting > kMaxDepth) {
+                Fail();
+                return;
+            }
+
+            Unary();
+            nesting--;
+        } else {
+            Power();
+        }
+    }
+
+    void
+    Power() {
+        Primary();
+        if (ok && Accept('^')) {
+            Unary();
+            Emit(Op::Pow);
+        }
+    }
+
+    void
+    Primary() {
+        if (!ok) {
+            return;
+        }
+
+        if (Accept('(')) {
+            Expr();
+            if (ok && !Accept(')')) {
+                Fail();
+            }
+            return;
+        }
+
+        SkipSpace();
+        if (pos == text.size()) {
+            Fail();
+            return;
+        }
+
+        char c = text[pos];
+        if (((c >= '0') && (c <= '9')) || (c == '.')) {
+            double val;
+            size_t len = ParseIniNumber(text.substr(pos), val);
+            if (!len) {
+                Fail();
+                return;
+            }
+
+            pos += len;
+            Emit(Op::Const, val);
+            return;
+        }
+
+        size_t start = pos;
+        while ((pos < text.size()) && (((text[pos] >= 'a') && (text[pos] <= 'z'))
+                || ((text[pos] >= 'A') && (text[pos] <= 'Z')))) {
+            pos++;
+        }
+
+        std::string_view name = text.substr(start, pos - start);
+        if (name.empty()) {
+            Fail();
+            return;
+        } else if (IniNameEquals(name, "level")) {
+            Emit(Op::Level);
+            return;
+        }
+
+        for (const Function *f = kFunctions; f->name; f++) {
+            if (IniNameEquals(name, f->name)) {
+                Call(f->op);
+                return;
+            }
+        }
+
+        pos = start;
+        Fail();
+    }
+
+    /**
+     * @brief Parses the arguments of a function call, and then emits it.
+     */
+    void
+    Call(
+        Op op
+    ) {
+        if (!Accept('(')) {
+            Fail();
+            return;
+        }
+
+        int n = Arity(op);
+        for (int i = 0; ok && (i < n); i++) {
+            if ((i > 0) && !Accept(',')) {
+                Fail();
+                return;
+            }
+
+            Expr();
+        }
+
+        if (ok && !Accept(')')) {
+            Fail();
+        }
+
+        if (ok) {
+            Emit(op);
+        }
+    }
+
+  public:
+    Parser(
+        std::string_view text,
+        std::vector<Instr> &code
+    ) : text(text),
+        code(code),
+        pos(0),
+        depth(0),
+        nesting(0),
+        ok(true)
+    {}
+
+    /**
+     * @brief Parses the whole text into the program.
+     * @param error Returns the position of the error, if the parse failed.
+     * @return True if the text was a valid formula.
+     */
+    bool
+    Run(
+        size_t &error
+    ) {
+        Expr();
+        SkipSpace();
+        if (ok && (pos != text.size())) {
+            Fail();
+        }
+
+        if (!ok) {
+            error = pos;
+            return false;
+        }
+
+        ASSERT(depth == 1);
+        return true;
+    }
+};
+
+const Formula::Parser::Function Formula::Parser::kFunctions[] = {
+    { "min", Op::Min },
+    { "max", Op::Max },
+    { "pow", Op::Pow },
+    { "sqrt", Op::Sqrt },
+    { "exp", Op::Exp },
+    { "log", Op::Log },
+    { "floor", Op::Floor },
+    { "ceil", Op::Ceil },
+    { nullptr, Op::Const }
+};
+
+/**
+ * @brief Gets the number of values an operation takes from the stack.
+ */
+int
+Formula::Arity(
+    Op op
+) {
+    switch (op) {
+        case Op::Const:
+        case Op::Level:
+            return 0;
+        case Op::Neg:
+        case Op::Sqrt:
+        case Op::Exp:
+        case Op::Log:
+        case Op::Floor:
+        case Op::Ceil:
+            return 1;
+        default:
+            return 2;
+    }
+}
+
+/**
+ * @brief Applies an operation to its arguments.
+ * @param op The operation to apply. Must not be Const or Level.
+ * @param args The arguments of the operation, in the order they were written.
+ */
+double
+Formula::Apply(
+    Op op,
+    const double *args
+) {
+    double ret = 0;
+    switch (op) {
+        case Op::Add:
+            ret = args[0] + args[1];
+            break;
+        case Op::Sub:
+            ret = args[0] - args[1];
+            break;
+        case Op::Mul:
+            ret = args[0] * args[1];
+            break;
+        case Op::Div:
+            ret = args[0] / args[1];
+            break;
+        case Op::Pow:
+            ret = std::pow(args[0], args[1]);
+            break;
+        case Op::Neg:
+            ret = -args[0];
+            break;
+        case Op::Min:
+            ret = std::fmin(args[0], args[1]);
+            break;
+        case Op::Max:
+            ret = std::fmax(args[0], args[1]);
+            break;
+        case Op::Sqrt:
+            ret = std::sqrt(args[0]);
+            break;
+        case Op::Exp:
+            ret = std::exp(args[0]);
+            break;
+        case Op::Log:
+            ret = std::log(args[0]);
+            break;
+        case Op::Floor:
+            ret = std::floor(args[0]);
+            break;
+        case Op::Ceil:
+            ret = std::ceil(args[0]);
+            break;
+        default:
+            HALT("Cannot apply a formula operation which takes no arguments.");
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Parses the given text into a formula.
+ *
+ * If the text is not a valid formula, the formula is left empty.
+ *
+ * @param text The text of the formula.
+ * @param error Returns the position of the error, if the text was invalid.
+ * @return True if the text was a valid formula.
+ */
+bool
+Formula::Parse(
+    std::string_view text,
+    size_t &error
+) {
+    code.clear();
+    if (!Parser(text, code).Run(error)) {
+        Clear();
+        return false;
+    }
+
+    code.shrink_to_fit();
+    return true;
+}
+
+/**
+ * @brief Evaluates the formula at the given level.
+ *
+ * The result may be infinite or NaN, such as when dividing by zero, so it must
+ * be checked by the caller.
+ */
+double
+Formula::Eval(
+    double level
+) const {
+    ASSERT(!code.empty());
+
+    double stack[kMaxDepth];
+    size_t sp = 0;
+    for (const Instr &in : code) {
+        if (in.op == Op::Const) {
+            stack[sp++] = in.val;
+        } else if (in.op == Op::Level) {
+            stack[sp++] = level;
+        } else {
+            sp -= Arity(in.op);
+            stack[sp] = Apply(in.op, &stack[sp]);
+            sp++;
+        }
+    }
+
+    ASSERT(sp == 1);
+    return stack[0];
+}
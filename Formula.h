@@ -0,0 +1,73 @@
+/**
+ * @file Formula.h
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Compiles arithmetic expressions from the INI file into bytecode.
+ * @bug No known bugs.
+ */
+
+#ifndef __SKYRIM_UNCAPPER_AE_FORMULA_H__
+#define __SKYRIM_UNCAPPER_AE_FORMULA_H__
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief A small arithmetic expression over the variable "level".
+ *
+ * Expressions may use numbers, level, the operators + - * / ^, parentheses,
+ * and the functions min, max, pow, sqrt, exp, log, floor and ceil. They are
+ * parsed into a postfix program, with any part which does not depend on the
+ * level folded into a constant. Formulas are only evaluated while the
+ * settings are compiled, so speed of evaluation is not a concern.
+ */
+class Formula {
+  private:
+    enum class Op : uint8_t {
+        Const,
+        Level,
+        Add,
+        Sub,
+        Mul,
+        Div,
+        Pow,
+        Neg,
+        Min,
+        Max,
+        Sqrt,
+        Exp,
+        Log,
+        Floor,
+        Ceil
+    };
+
+    struct Instr {
+        Op op;
+        double val;
+    };
+
+    /// @brief The deepest the evaluation stack of a formula may get.
+    static const size_t kMaxDepth = 32;
+
+    class Parser;
+
+    std::vector<Instr> code;
+
+    static int Arity(Op op);
+    static double Apply(Op op, const double *args);
+
+  public:
+    bool Parse(std::string_view text, size_t &error);
+    double Eval(double level) const;
+
+    /// @brief Checks if the formula has been parsed.
+    inline bool Empty(void) const { return code.empty(); }
+
+    /// @brief Gets the number of instructions in the program of the formula.
+    inline size_t Size(void) const { return code.size(); }
+
+    /// @brief Discards the program of the formula.
+    inline void Clear(void) { std::vector<Instr>().swap(code); }
+};
+
+#endif /* __SKYRIM_UNCAPPER_AE_FORMULA_H__ */
@@ -0,0 +1,450 @@
+/**
+ * @file HookTrace.cpp
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Implementation of the hook trace recorder and reader.
+ * @bug Records made in the last moments before the game exits may not reach
+ *      the trace file, as the game never stops the recorder.
+ */
+
+#include "HookTrace.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
+/// @brief The number of records each thread can hold before they're drained.
+static const UInt32 kRingSize = 4096;
+
+/// @brief How often the writer thread drains the rings, in milliseconds.
+static const unsigned int kDrainMs = 100;
+
+/// @brief The most threads a trace file may hold records from.
+static const UInt32 kMaxThreads = 4096;
+
+/// @brief Where the fields after the time and hook start in a record, and
+///        their size. Each encoded record has a mask of the bytes of these
+///        fields which changed.
+static const UInt32 kFieldsOffset = offsetof(HookTraceRecord, attr);
+static const UInt32 kFieldsSize = sizeof(HookTraceRecord) - kFieldsOffset;
+static const UInt32 kMaskBytes = (kFieldsSize + 7) / 8;
+
+/// @brief Global hook trace, which the hooks record to.
+HookTrace hookTrace;
+
+const char HookTrace::kMagic[4] = { 'S', 'U', 'H', 'T' };
+
+const char *const HookTrace::kHookNames[kHookCount] = {
+    "SkillCap",
+    "ChargeSettings",
+    "ChargePoints",
+    "GetCurrent",
+    "ImproveSkill",
+    "PerkPool",
+    "LevelExp",
+    "Attributes",
+    "LegendaryReset",
+    "LegendaryCheck",
+    "LegendaryButton"
+};
+
+/**
+ * @brief The records of one thread which are waiting to be written.
+ *
+ * Only the thread which owns the ring moves the head, and only the writer
+ * moves the tail, so neither needs a lock.
+ */
+struct HookTrace::Ring {
+    std::atomic<UInt32> head;
+    std::atomic<UInt32> tail;
+    std::atomic<UInt32> dropped;
+
+    /// @brief The thread's index in the trace file.
+    UInt32 index;
+
+    /// @brief The last record of each hook written to the trace file, which
+    ///        the next one is encoded against. Only used by the writer.
+    HookTraceRecord last[HookTrace::kHookCount];
+
+    /// @brief The time of the last record written to the trace file.
+    UInt64 lastTsc;
+
+    HookTraceRecord records[kRingSize];
+};
+
+/**
+ * @brief Creates a recorder which isn't recording.
+ */
+HookTrace::HookTrace(
+) : recording(false),
+    stopping(false)
+{}
+
+/**
+ * @brief Frees the rings of every thread.
+ *
+ * The game never stops the recorder, and has ended the writer thread with the
+ * rest of its threads by the time this runs, so the thread is let go.
+ */
+HookTrace::~HookTrace() {
+    if (writer.joinable()) {
+        writer.detach();
+        return;
+    }
+
+    for (Ring *ring : rings) {
+        delete ring;
+    }
+}
+
+/**
+ * @brief Gets the ring of the calling thread, creating it on the first call.
+ */
+HookTrace::Ring *
+HookTrace::GetRing() {
+    static thread_local Ring *ring = nullptr;
+    if (!ring) {
+        Ring *next = new Ring();
+        next->head = 0;
+        next->tail = 0;
+        next->dropped = 0;
+        memset(next->last, 0, sizeof(next->last));
+        next->lastTsc = 0;
+
+        std::lock_guard<std::mutex> guard(lock);
+        next->index = static_cast<UInt32>(rings.size());
+        rings.push_back(next);
+        ring = next;
+    }
+
+    return ring;
+}
+
+/**
+ * @brief Starts recording hook calls to the given trace file.
+ *
+ * Must be called before the hooks are installed, or while none are running.
+ *
+ * @param path The path to write the trace to. Any existing file is replaced.
+ * @return True if recording started.
+ */
+bool
+HookTrace::Start(
+    const std::string &path
+) {
+    ASSERT(!recording);
+
+    file.open(path, std::ios::binary | std::ios::trunc);
+    FileHeader header = { { kMagic[0], kMagic[1], kMagic[2], kMagic[3] }, kVersion,
+                          sizeof(HookTraceRecord) };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!file) {
+        _ERROR("Failed to create the hook trace %s.", path.c_str());
+        file.close();
+        return false;
+    }
+
+    // Threads which recorded to an earlier trace start this one afresh.
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        for (Ring *ring : rings) {
+            ring->tail = ring->head.load();
+            ring->dropped = 0;
+            memset(ring->last, 0, sizeof(ring->last));
+            ring->lastTsc = 0;
+        }
+    }
+
+    stopping = false;
+    writer = std::thread(&HookTrace::RunWriter, this);
+    recording = true;
+    _MESSAGE("Recording hook calls to %s.", path.c_str());
+    return true;
+}
+
+/**
+ * @brief Stops recording, and writes out every record made so far.
+ *
+ * Must only be called once no hook can be running.
+ */
+void
+HookTrace::Stop() {
+    if (!recording) {
+        return;
+    }
+
+    recording = false;
+    stopping = true;
+    writer.join();
+    Drain();
+    file.close();
+}
+
+/**
+ * @brief Writes out every record made so far.
+ */
+void
+HookTrace::Flush() {
+    Drain();
+}
+
+/**
+ * @brief Records calls to hooks, which are stamped with the current time.
+ *
+ * The records are kept together, so if they don't all fit in the thread's
+ * ring then none of them are recorded.
+ *
+ * @param records The records to add.
+ * @param count The number of records.
+ */
+void
+HookTrace::Record(
+    HookTraceRecord *records,
+    size_t count
+) {
+    Ring *ring = GetRing();
+    UInt32 head = ring->head.load(std::memory_order_relaxed);
+    UInt32 tail = ring->tail.load(std::memory_order_acquire);
+    if ((kRingSize - (head - tail)) < count) {
+        ring->dropped.fetch_add(static_cast<UInt32>(count), std::memory_order_relaxed);
+        return;
+    }
+
+    UInt64 tsc = __rdtsc();
+    for (size_t i = 0; i < count; i++) {
+        records[i].tsc = tsc;
+        ring->records[(head + i) & (kRingSize - 1)] = records[i];
+    }
+
+    ring->head.store(head + static_cast<UInt32>(count), std::memory_order_release);
+}
+
+/**
+ * @brief Encodes the waiting records of every thread into the trace file.
+ */
+void
+HookTrace::Drain() {
+    std::lock_guard<std::mutex> guard(lock);
+    if (!file.is_open()) {
+        return;
+    }
+
+    std::vector<UInt8> data;
+    for (Ring *ring : rings) {
+        UInt32 head = ring->head.load(std::memory_order_acquire);
+        UInt32 tail = ring->tail.load(std::memory_order_relaxed);
+        UInt32 dropped = ring->dropped.exchange(0, std::memory_order_relaxed);
+        if ((head == tail) && !dropped) {
+            continue;
+        }
+
+        data.clear();
+        for (UInt32 i = tail; i != head; i++) {
+            const HookTraceRecord &rec = ring->records[i & (kRingSize - 1)];
+            HookTraceRecord &prev = ring->last[rec.hook];
+            data.push_back(rec.hook);
+
+            // The time is stored as the time since the thread's last record.
+            UInt64 delta = rec.tsc - ring->lastTsc;
+            ring->lastTsc = rec.tsc;
+            do {
+                data.push_back(static_cast<UInt8>((delta & 0x7F) | ((delta > 0x7F) ? 0x80 : 0)));
+                delta >>= 7;
+            } while (delta);
+
+            // Then comes the mask of the bytes which changed since the hook's
+            // last record, and those bytes.
+            const UInt8 *cur = reinterpret_cast<const UInt8*>(&rec) + kFieldsOffset;
+            UInt8 *old = reinterpret_cast<UInt8*>(&prev) + kFieldsOffset;
+            size_t at = data.size();
+            data.resize(at + kMaskBytes);
+            UInt32 mask = 0;
+            for (UInt32 b = 0; b < kFieldsSize; b++) {
+                UInt8 diff = cur[b] ^ old[b];
+                if (diff) {
+                    mask |= 1u << b;
+                    data.push_back(diff);
+                }
+            }
+
+            for (UInt32 b = 0; b < kMaskBytes; b++) {
+                data[at + b] = static_cast<UInt8>(mask >> (8 * b));
+            }
+
+            prev = rec;
+        }
+
+        BlockHeader header = { ring->index, head - tail, dropped, static_cast<UInt32>(data.size()) };
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+        ring->tail.store(head, std::memory_order_release);
+    }
+
+    file.flush();
+}
+
+/**
+ * @brief Drains the rings to the trace file until the recorder stops.
+ */
+void
+HookTrace::RunWriter() {
+    while (!stopping.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(kDrainMs));
+        Drain();
+    }
+}
+
+/**
+ * @brief Gets the name of the given hook.
+ */
+const char *
+HookTrace::Str(
+    Hook hook
+) {
+    ASSERT(hook < kHookCount);
+    return kHookNames[hook];
+}
+
+/**
+ * @brief Creates a reader with no trace open.
+ */
+HookTraceReader::HookTraceReader(
+) : pos(0),
+    thread(0),
+    left(0),
+    dropped(0),
+    failed(false)
+{}
+
+/**
+ * @brief Opens a trace file, and checks that it's one this reader can read.
+ * @param path The path of the trace file.
+ * @return True if the trace was opened.
+ */
+bool
+HookTraceReader::Open(
+    const std::string &path
+) {
+    file.open(path, std::ios::binary);
+    HookTrace::FileHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || memcmp(header.magic, HookTrace::kMagic, sizeof(header.magic))
+            || (header.version != HookTrace::kVersion)
+            || (header.recordSize != sizeof(HookTraceRecord))) {
+        _ERROR("%s is not a hook trace this version can read.", path.c_str());
+        failed = true;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Reads the next block of records.
+ * @return False at the end of the trace, or if the block is cut short.
+ */
+bool
+HookTraceReader::ReadBlock() {
+    HookTrace::BlockHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (file.gcount() == 0) {
+        return false;
+    }
+
+    if ((file.gcount() != sizeof(header)) || (header.thread >= kMaxThreads)) {
+        failed = true;
+        return false;
+    }
+
+    block.resize(header.size);
+    file.read(reinterpret_cast<char*>(block.data()), header.size);
+    if (static_cast<size_t>(file.gcount()) != header.size) {
+        failed = true;
+        return false;
+    }
+
+    if (header.thread >= threads.size()) {
+        ThreadState zero;
+        memset(&zero, 0, sizeof(zero));
+        threads.resize(header.thread + 1, zero);
+    }
+
+    pos = 0;
+    thread = header.thread;
+    left = header.count;
+    dropped += header.dropped;
+    return true;
+}
+
+/**
+ * @brief Reads the next record of the trace.
+ * @param rec Returns the record.
+ * @return False at the end of the trace, or if the trace is corrupt.
+ */
+bool
+HookTraceReader::Next(
+    HookTraceRecord &rec
+) {
+    while (!left) {
+        if (failed || !file.is_open() || !ReadBlock()) {
+            return false;
+        }
+    }
+
+    ThreadState &state = threads[thread];
+    if ((pos >= block.size()) || (block[pos] >= HookTrace::kHookCount)) {
+        failed = true;
+        return false;
+    }
+
+    HookTraceRecord &last = state.last[block[pos++]];
+
+    UInt64 delta = 0;
+    for (unsigned int shift = 0; ; shift += 7) {
+        if ((pos >= block.size()) || (shift >= 64)) {
+            failed = true;
+            return false;
+        }
+
+        UInt8 byte = block[pos++];
+        delta |= static_cast<UInt64>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            break;
+        }
+    }
+
+    if ((block.size() - pos) < kMaskBytes) {
+        failed = true;
+        return false;
+    }
+
+    UInt32 mask = 0;
+    for (UInt32 b = 0; b < kMaskBytes; b++) {
+        mask |= static_cast<UInt32>(block[pos++]) << (8 * b);
+    }
+
+    UInt8 *bytes = reinterpret_cast<UInt8*>(&last) + kFieldsOffset;
+    for (UInt32 b = 0; b < kFieldsSize; b++) {
+        if (mask & (1u << b)) {
+            if (pos >= block.size()) {
+                failed = true;
+                return false;
+            }
+
+            bytes[b] ^= block[pos++];
+        }
+    }
+
+    state.tsc += delta;
+    last.tsc = state.tsc;
+    last.hook = static_cast<UInt8>(&last - state.last);
+
+    left--;
+    rec = last;
+    return true;
+}
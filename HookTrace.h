@@ -0,0 +1,245 @@
+/**
+ * @file HookTrace.h
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Records the inputs and results of every hook call to a compact trace
+ *        file, which can be replayed through the hooks offline.
+ * @bug No known bugs.
+ */
+
+#ifndef __SKYRIM_UNCAPPER_AE_HOOK_TRACE_H__
+#define __SKYRIM_UNCAPPER_AE_HOOK_TRACE_H__
+
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ActorAttribute.h"
+
+/**
+ * @brief One call to a hook, with everything the hook read from the game and
+ *        everything it gave back.
+ *
+ * The values hold the hook's inputs followed by its results, as listed for
+ * each hook in HookTrace::Hook. Values a hook doesn't use are zero.
+ */
+struct HookTraceRecord {
+    /// @brief The time stamp counter when the hook was called.
+    UInt64 tsc;
+
+    /// @brief The hook which was called, from HookTrace::Hook.
+    UInt8 hook;
+
+    /// @brief The attribute the hook was called with, if any.
+    UInt8 attr;
+
+    /// @brief The player's level, if the hook read it.
+    UInt16 level;
+
+    float values[5];
+};
+
+static_assert(sizeof(HookTraceRecord) == 32, "Trace records must stay 32 bytes.");
+
+/**
+ * @brief Records hook calls into a buffer for each thread, which a background
+ *        thread drains to the trace file.
+ *
+ * Each thread which calls a hook gets its own ring of records, which only that
+ * thread writes and only the writer thread reads, so recording takes no lock.
+ * Records which don't fit in a full ring are dropped and counted.
+ *
+ * The trace file starts with a HookTrace::FileHeader, followed by blocks of
+ * records from one thread each. Each record is stored as its hook, the time
+ * since the thread's last record as a varint, and then a mask of the
+ * bytes of the other fields which changed since the thread's last call to the
+ * same hook, followed by those bytes XORed with their old values. Calls to a
+ * hook differ in few bytes, so most records take well under half their size.
+ */
+class HookTrace {
+  public:
+    /**
+     * @brief The hooks which are recorded, and the layout of their values.
+     *
+     * The order of these values MUST NOT be changed, as it is saved in traces.
+     */
+    enum Hook {
+        /// @brief values: cap.
+        SkillCap,
+
+        /// @brief values: fEnchantingCostExponent, fEnchantingSkillCostBase,
+        ///        fEnchantingSkillCostScale, fEnchantingSkillCostMult.
+        ///
+        /// Always recorded right before the ChargePoints record it belongs to.
+        ChargeSettings,
+
+        /// @brief values: base points, max charge, enchanting level, result.
+        ChargePoints,
+
+        /// @brief values: current value, result.
+        GetCurrent,
+
+        /// @brief values: exp, skill level, exp given to the game.
+        ImproveSkill,
+
+        /// @brief values: points, count, result.
+        PerkPool,
+
+        /// @brief values: exp, skill level, result.
+        LevelExp,
+
+        /// @brief values: health, magicka, stamina and carry weight gained.
+        Attributes,
+
+        /// @brief values: reset level, skill level, new reset level.
+        LegendaryReset,
+
+        /// @brief values: skill level, result.
+        LegendaryCheck,
+
+        /// @brief values: skill level, result.
+        LegendaryButton,
+
+        kHookCount
+    };
+
+    /// @brief The first bytes of a trace file.
+    struct FileHeader {
+        char magic[4];
+        UInt32 version;
+        UInt32 recordSize;
+    };
+
+    /// @brief The start of a block of records from one thread.
+    struct BlockHeader {
+        /// @brief The thread the records are from.
+        UInt32 thread;
+
+        /// @brief The number of records in the block.
+        UInt32 count;
+
+        /// @brief The number of records the thread dropped since its last
+        ///        block.
+        UInt32 dropped;
+
+        /// @brief The size of the encoded records, in bytes.
+        UInt32 size;
+    };
+
+    static const char kMagic[4];
+    static const UInt32 kVersion = 1;
+
+  private:
+    struct Ring;
+
+    /// @brief Whether hook calls are recorded. Only set before the hooks are
+    ///        installed, or after they stop running.
+    bool recording;
+
+    /// @brief Guards the list of rings, and the draining of them.
+    std::mutex lock;
+    std::vector<Ring*> rings;
+
+    std::ofstream file;
+    std::thread writer;
+    std::atomic<bool> stopping;
+
+    static const char *const kHookNames[kHookCount];
+
+    Ring *GetRing(void);
+    void Drain(void);
+    void RunWriter(void);
+
+  public:
+    HookTrace();
+    ~HookTrace();
+
+    HookTrace(const HookTrace &) = delete;
+    HookTrace &operator=(const HookTrace &) = delete;
+
+    /// @brief Checks if hook calls are being recorded.
+    inline bool IsRecording(void) const { return recording; }
+
+    bool Start(const std::string &path);
+    void Stop(void);
+    void Flush(void);
+    void Record(HookTraceRecord *records, size_t count);
+
+    /**
+     * @brief Records a call to a hook.
+     * @param values The inputs and results of the call, laid out as listed
+     *        for the hook.
+     */
+    inline void
+    Record(
+        Hook hook,
+        ActorAttribute::t attr,
+        UInt16 level,
+        const float (&values)[5]
+    ) {
+        HookTraceRecord rec = {
+            0,
+            static_cast<UInt8>(hook),
+            static_cast<UInt8>(attr),
+            level,
+            { values[0], values[1], values[2], values[3], values[4] }
+        };
+        Record(&rec, 1);
+    }
+
+    /// @brief Records a call to a hook which isn't given an attribute.
+    inline void
+    Record(
+        Hook hook,
+        UInt16 level,
+        const float (&values)[5]
+    ) {
+        Record(hook, static_cast<ActorAttribute::t>(0), level, values);
+    }
+
+    static const char *Str(Hook hook);
+};
+
+/**
+ * @brief Reads the records of a trace file back, in the order they were
+ *        written.
+ */
+class HookTraceReader {
+  private:
+    std::ifstream file;
+
+    /// @brief What the records of a thread are decoded against.
+    struct ThreadState {
+        HookTraceRecord last[HookTrace::kHookCount];
+        UInt64 tsc;
+    };
+
+    std::vector<ThreadState> threads;
+
+    std::vector<UInt8> block;
+    size_t pos;
+    UInt32 thread;
+    UInt32 left;
+    UInt64 dropped;
+    bool failed;
+
+    bool ReadBlock(void);
+
+  public:
+    HookTraceReader();
+
+    bool Open(const std::string &path);
+    bool Next(HookTraceRecord &rec);
+
+    /// @brief Checks if the trace was cut short or corrupt.
+    inline bool Failed(void) const { return failed; }
+
+    /// @brief Gets the number of records dropped before the ones read so far.
+    inline UInt64 Dropped(void) const { return dropped; }
+};
+
+extern HookTrace hookTrace;
+
+#endif /* __SKYRIM_UNCAPPER_AE_HOOK_TRACE_H__ */
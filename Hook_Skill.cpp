@@ -16,7 +16,9 @@
 #include "GameSettings.h"
 
 #include "HookWrappers.h"
+#include "HookTrace.h"
 #include "Settings.h"
+#include "SettingsStore.h"
 #include "RelocFn.h"
 #include "Compare.h"
 #include "ActorAttribute.h"
@@ -29,7 +31,14 @@ GetSkillCap_Hook(
     ActorAttribute::t skill
 ) {
     ASSERT(settings.IsSkillCapEnabled());
-    return settings.GetSkillCap(skill);
+    SettingsReader config;
+    float cap = config->GetSkillCap(skill);
+
+    if (hookTrace.IsRecording()) {
+        hookTrace.Record(HookTrace::SkillCap, skill, 0, { cap });
+    }
+
+    return cap;
 }
 
 /**
@@ -50,30 +59,41 @@ CalculateChargePointsPerUse_Hook(
     float max_charge
 ) {
     ASSERT(settings.IsEnchantPatchEnabled());
+    SettingsReader config;
 
     float cost_exponent = *GetFloatGameSetting("fEnchantingCostExponent");
     float cost_base = *GetFloatGameSetting("fEnchantingSkillCostBase");
     float cost_scale = *GetFloatGameSetting("fEnchantingSkillCostScale");
     float cost_mult = *GetFloatGameSetting("fEnchantingSkillCostMult");
-    float cap = settings.GetEnchantChargeCap();
-    float enchanting_level = MIN(
-        PlayerAVOGetCurrent_Original(player_av, ActorAttribute::Enchanting),
-        cap
-    );
+    float cap = config->GetEnchantChargeCap();
+    float current = PlayerAVOGetCurrent_Original(player_av, ActorAttribute::Enchanting);
+    float enchanting_level = MIN(current, cap);
 
     float base = cost_mult * pow(base_points, cost_exponent);
 
-    if (settings.IsEnchantChargeLinear()) {
+    float points;
+    if (config->IsEnchantChargeLinear()) {
         // Linearly scale between the normal min/max of charge points.
         float max_level_scale = pow(cap * cost_base, cost_scale);
         float slope = (max_charge * max_level_scale) / (base * (1.0f - max_level_scale) * cap);
         float intercept = max_charge / base;
         float linear_charge = slope * enchanting_level + intercept;
-        return max_charge / linear_charge;
+        points = max_charge / linear_charge;
     } else {
         // Original game equation.
-        return base * (1.0f - pow(enchanting_level * cost_base, cost_scale));
+        points = base * (1.0f - pow(enchanting_level * cost_base, cost_scale));
+    }
+
+    // The game settings are recorded first, so the call can be replayed.
+    if (hookTrace.IsRecording()) {
+        HookTraceRecord recs[2] = {
+            { 0, HookTrace::ChargeSettings, 0, 0, { cost_exponent, cost_base, cost_scale, cost_mult } },
+            { 0, HookTrace::ChargePoints, 0, 0, { base_points, max_charge, current, points } }
+        };
+        hookTrace.Record(recs, 2);
     }
+
+    return points;
 }
 
 /**
@@ -89,19 +109,25 @@ PlayerAVOGetCurrent_Hook(
     // FIXME: Need to find where this is called in the text color code and
     //        replace it so the skills menu is actually correct.
 
-    float val = PlayerAVOGetCurrent_Original(av, attr);
+    SettingsReader config;
+    float current = PlayerAVOGetCurrent_Original(av, attr);
+    float val = current;
 
     if (ActorAttribute::IsSkill(attr)) {
-        val = MAX(0, MIN(val, settings.GetSkillFormulaCap(attr)));
+        val = MAX(0, MIN(val, config->GetSkillFormulaCap(attr)));
 
         // If this is a call for enchanting, we enforce the magnitude
         // cap here. Note that this hook is never called for charge
         // calculation; we overwrite the code which would have.
         if (attr == ActorAttribute::Enchanting) {
-            val = MIN(val, settings.GetSkillFormulaCap(ActorAttribute::Enchanting));
+            val = MIN(val, config->GetSkillFormulaCap(ActorAttribute::Enchanting));
         }
     }
 
+    if (hookTrace.IsRecording()) {
+        hookTrace.Record(HookTrace::GetCurrent, attr, 0, { current, val });
+    }
+
     return val;
 }
 
@@ -119,16 +145,22 @@ ImprovePlayerSkillPoints_Hook(
     bool unk4
 ) {
     ASSERT(settings.IsSkillExpEnabled());
+    SettingsReader config;
 
+    float skill_level = 0;
+    UInt16 player_level = 0;
+    float mult_exp = exp;
     if (ActorAttribute::IsSkill(attr)) {
-        exp *= settings.GetSkillExpGainMult(
-            attr,
-            PlayerAVOGetBase(attr),
-            GetPlayerLevel()
-        );
+        skill_level = PlayerAVOGetBase(attr);
+        player_level = GetPlayerLevel();
+        mult_exp *= config->GetSkillExpGainMult(attr, skill_level, player_level);
     }
 
-    ImprovePlayerSkillPoints_Original(skill_data, attr, exp, unk1, unk2, unk3, unk4);
+    if (hookTrace.IsRecording()) {
+        hookTrace.Record(HookTrace::ImproveSkill, attr, player_level, { exp, skill_level, mult_exp });
+    }
+
+    ImprovePlayerSkillPoints_Original(skill_data, attr, mult_exp, unk1, unk2, unk3, unk4);
 }
 
 /**
@@ -144,9 +176,22 @@ ModifyPerkPool_Hook(
     SInt8 count
 ) {
     ASSERT(settings.IsPerkPointsEnabled());
-    int delta = MIN(0xFF, settings.GetPerkDelta(GetPlayerLevel()));
+    SettingsReader config;
+
+    UInt16 player_level = GetPlayerLevel();
+    int delta = MIN(0xFF, config->GetPerkDelta(player_level));
     int res = points + ((count > 0) ? delta : count);
-    return static_cast<UInt8>(MAX(0, MIN(0xFF, res)));
+    UInt8 new_points = static_cast<UInt8>(MAX(0, MIN(0xFF, res)));
+
+    if (hookTrace.IsRecording()) {
+        hookTrace.Record(HookTrace::PerkPool, player_level, {
+            static_cast<float>(points),
+            static_cast<float>(count),
+            static_cast<float>(new_points)
+        });
+    }
+
+    return new_points;
 }
 
 /**
@@ -161,15 +206,22 @@ ImproveLevelExpBySkillLevel_Hook(
     ActorAttribute::t attr
 ) {
     ASSERT(settings.IsLevelExpEnabled());
+    SettingsReader config;
+
+    float skill_level = 0;
+    UInt16 player_level = 0;
+    float mult_exp = exp;
     if (ActorAttribute::IsSkill(attr)) {
-        exp *= settings.GetLevelSkillExpMult(
-            attr,
-            PlayerAVOGetBase(attr),
-            GetPlayerLevel()
-        );
+        skill_level = PlayerAVOGetBase(attr);
+        player_level = GetPlayerLevel();
+        mult_exp *= config->GetLevelSkillExpMult(attr, skill_level, player_level);
     }
 
-    return exp;
+    if (hookTrace.IsRecording()) {
+        hookTrace.Record(HookTrace::LevelExp, attr, player_level, { exp, skill_level, mult_exp });
+    }
+
+    return mult_exp;
 }
 
 /**
@@ -187,22 +239,42 @@ ImproveAttributeWhenLevelUp_Hook(
 ) {
     (void)player_avo;
     ASSERT(settings.IsAttributePointsEnabled());
-    
+    SettingsReader config;
+
+    UInt16 player_level = GetPlayerLevel();
     ActorAttributeLevelUp level_up;
-    settings.GetAttributeLevelUp(
-        GetPlayerLevel(),
+    config->GetAttributeLevelUp(
+        player_level,
         choice,
         level_up
     );
 
-    PlayerAVOModBase(ActorAttribute::Health, level_up.health);
-    PlayerAVOModBase(ActorAttribute::Magicka, level_up.magicka);
-    PlayerAVOModBase(ActorAttribute::Stamina, level_up.stamina);
-    PlayerAVOModCurrent(
-        0, // Same as OG call.
-        ActorAttribute::CarryWeight,
-        level_up.carry_weight
-    );
+    if (hookTrace.IsRecording()) {
+        hookTrace.Record(HookTrace::Attributes, choice, player_level, {
+            level_up.health,
+            level_up.magicka,
+            level_up.stamina,
+            level_up.carry_weight
+        });
+    }
+
+    // Modding an attribute by zero does nothing, so we skip those calls.
+    if (level_up.health != 0) {
+        PlayerAVOModBase(ActorAttribute::Health, level_up.health);
+    }
+    if (level_up.magicka != 0) {
+        PlayerAVOModBase(ActorAttribute::Magicka, level_up.magicka);
+    }
+    if (level_up.stamina != 0) {
+        PlayerAVOModBase(ActorAttribute::Stamina, level_up.stamina);
+    }
+    if (level_up.carry_weight != 0) {
+        PlayerAVOModCurrent(
+            0, // Same as OG call.
+            ActorAttribute::CarryWeight,
+            level_up.carry_weight
+        );
+    }
 }
 
 /**
@@ -213,8 +285,18 @@ LegendaryResetSkillLevel_Hook(
     float base_level
 ) {
     ASSERT(settings.IsLegendaryEnabled());
+    SettingsReader config;
     float *reset_val = GetFloatGameSetting("fLegendarySkillResetValue");
-    *reset_val = settings.GetPostLegendarySkillLevel(*reset_val, base_level);
+    float old_reset = *reset_val;
+    *reset_val = config->GetPostLegendarySkillLevel(old_reset, base_level);
+
+    if (hookTrace.IsRecording()) {
+        hookTrace.Record(HookTrace::LegendaryReset, 0, {
+            old_reset,
+            base_level,
+            *reset_val
+        });
+    }
 }
 
 /**
@@ -225,9 +307,17 @@ CheckConditionForLegendarySkill_Hook(
     void *player_actor,
     ActorAttribute::t skill
 ) {
+    (void)player_actor;
     ASSERT(settings.IsLegendaryEnabled());
+    SettingsReader config;
     float skill_level = PlayerAVOGetBase(skill);
-    return settings.IsLegendaryAvailable(skill);
+    bool available = config->IsLegendaryAvailable(skill_level);
+
+    if (hookTrace.IsRecording()) {
+        hookTrace.Record(HookTrace::LegendaryCheck, skill, 0, { skill_level, available ? 1.0f : 0.0f });
+    }
+
+    return available;
 }
 
 /**
@@ -239,7 +329,15 @@ HideLegendaryButton_Hook(
     void *player_actor,
     ActorAttribute::t skill
 ) {
+    (void)player_actor;
     ASSERT(settings.IsLegendaryEnabled());
+    SettingsReader config;
     float skill_level = PlayerAVOGetBase(skill);
-    return settings.IsLegendaryButtonVisible(skill_level);
+    bool visible = config->IsLegendaryButtonVisible(skill_level);
+
+    if (hookTrace.IsRecording()) {
+        hookTrace.Record(HookTrace::LegendaryButton, skill, 0, { skill_level, visible ? 1.0f : 0.0f });
+    }
+
+    return visible;
 }
@@ -0,0 +1,495 @@
+/**
+ * @file Ini.cpp
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Implementation of the INI tokenizer and writer.
+ * @bug No known bugs.
+ */
+
+#include "Ini.h"
+
+#include <algorithm>
+
+#include "AtomicFile.h"
+
+/// @brief The byte order mark which may start a UTF-8 file.
+static const char kUtf8Bom[] = "\xEF\xBB\xBF";
+
+/**
+ * @brief Checks if the given character is whitespace, including new lines.
+ */
+static inline bool
+IsSpace(
+    char c
+) {
+    return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n');
+}
+
+/**
+ * @brief Checks if the given character ends a line.
+ */
+static inline bool
+IsNewLine(
+    char c
+) {
+    return (c == '\r') || (c == '\n');
+}
+
+/**
+ * @brief Creates a tokenizer over the given INI file contents.
+ *
+ * The data must outlive the tokenizer, as must any views it returns.
+ *
+ * @param data The contents of the INI file. May be null if size is 0.
+ * @param size The size of the contents.
+ * @param headers True if section headers should also be returned, as entries
+ *                with an empty key.
+ */
+IniTokenizer::IniTokenizer(
+    const char *data,
+    size_t size,
+    bool headers
+) : pos(data),
+    end(data + size),
+    section(""),
+    headers(headers)
+{
+    size_t bom_len = sizeof(kUtf8Bom) - 1;
+    if ((size >= bom_len) && !memcmp(data, kUtf8Bom, bom_len)) {
+        pos += bom_len;
+    }
+}
+
+/**
+ * @brief Creates a view of the given range, with trailing whitespace removed.
+ */
+std::string_view
+IniTokenizer::TrimEnd(
+    const char *start,
+    const char *stop
+) {
+    while ((stop > start) && IsSpace(stop[-1])) {
+        stop--;
+    }
+
+    return std::string_view(start, stop - start);
+}
+
+/**
+ * @brief Moves the tokenizer to the end of the current line.
+ */
+void
+IniTokenizer::SkipLine() {
+    while ((pos < end) && !IsNewLine(*pos)) {
+        pos++;
+    }
+}
+
+/**
+ * @brief Gets the next entry in the file.
+ *
+ * Unless the tokenizer was asked for them, section headers are not returned
+ * on their own; they're reported with each of the entries which follow them.
+ * All the entries under one header share the same section view, so callers can
+ * detect a new header by its data pointer. A returned header has an empty key,
+ * and an empty value at the end of its line.
+ *
+ * @param sec Returns the section of the entry.
+ * @param key Returns the key of the entry.
+ * @param value Returns the value of the entry.
+ * @return True if an entry was found, false at the end of the file.
+ */
+bool
+IniTokenizer::Next(
+    std::string_view &sec,
+    std::string_view &key,
+    std::string_view &value
+) {
+    while (pos < end) {
+        // Skip blank lines and leading whitespace.
+        while ((pos < end) && IsSpace(*pos)) {
+            pos++;
+        }
+
+        if (pos == end) {
+            break;
+        }
+
+        if ((*pos == ';') || (*pos == '#')) {
+            SkipLine();
+            continue;
+        }
+
+        if (*pos == '[') {
+            pos++;
+            while ((pos < end) && IsSpace(*pos)) {
+                pos++;
+            }
+
+            const char *start = pos;
+            while ((pos < end) && (*pos != ']') && !IsNewLine(*pos)) {
+                pos++;
+            }
+
+            // Unterminated section headers are ignored.
+            if ((pos == end) || (*pos != ']')) {
+                continue;
+            }
+
+            section = TrimEnd(start, pos);
+            SkipLine();
+            if (headers) {
+                sec = section;
+                key = std::string_view();
+                value = std::string_view(pos, 0);
+                return true;
+            }
+            continue;
+        }
+
+        const char *key_start = pos;
+        while ((pos < end) && (*pos != '=') && !IsNewLine(*pos)) {
+            pos++;
+        }
+
+        // Keys without values and empty keys are ignored.
+        if ((pos == end) || (*pos != '=')) {
+            continue;
+        } else if (pos == key_start) {
+            SkipLine();
+            continue;
+        }
+
+        key = TrimEnd(key_start, pos);
+
+        pos++;
+        while ((pos < end) && !IsNewLine(*pos) && IsSpace(*pos)) {
+            pos++;
+        }
+
+        const char *value_start = pos;
+        SkipLine();
+        value = TrimEnd(value_start, pos);
+        sec = section;
+
+        return true;
+    }
+
+    return false;
+}
+
+/// @brief The line ending used when writing new INI files.
+static const char kNewLine[] = "\r\n";
+
+/**
+ * @brief Creates an empty INI file.
+ * @param reserve The expected size of the file, so that it can be written
+ *                without growing the buffer.
+ */
+IniWriter::IniWriter(
+    size_t reserve
+) : base(nullptr),
+    baseSize(0),
+    lastSection(0),
+    newLine(kNewLine),
+    sectionPos(0),
+    sectionLen(0)
+{
+    out.reserve(reserve);
+}
+
+/**
+ * @brief Creates a writer which updates the given INI file.
+ *
+ * The file is scanned once, recording where each section ends and where the
+ * value of each entry is, and which line ending it uses. The data must
+ * outlive the writer, or the call to Finish().
+ *
+ * @param data The contents of the INI file. May be null if size is 0.
+ * @param size The size of the contents.
+ */
+IniWriter::IniWriter(
+    const char *data,
+    size_t size
+) : base(data),
+    baseSize(size),
+    lastSection(0),
+    newLine(kNewLine),
+    sectionPos(0),
+    sectionLen(0)
+{
+    // Added lines end the same way as the lines already in the file.
+    const char *lf = static_cast<const char*>(memchr(data, '\n', size));
+    if (lf && ((lf == data) || (lf[-1] != '\r'))) {
+        newLine = "\n";
+    }
+
+    IniTokenizer tokenizer(data, size, true);
+    std::string_view sec, key, value;
+    const char *header = nullptr;
+    uint32_t current = 0;
+    while (tokenizer.Next(sec, key, value)) {
+        // A section may appear more than once; its entries are merged.
+        if (sec.data() != header) {
+            header = sec.data();
+            const BaseSection *found = FindSection(sec);
+            if (found) {
+                current = static_cast<uint32_t>(found - sections.data());
+            } else {
+                current = static_cast<uint32_t>(sections.size());
+                sections.push_back({ sec, 0, 0, 0 });
+            }
+        }
+
+        // New entries go after the line of the last entry in the section.
+        const char *eol = value.data() + value.size();
+        while ((eol < data + size) && !IsNewLine(*eol)) {
+            eol++;
+        }
+        if ((eol < data + size) && (*eol == '\r')) {
+            eol++;
+        }
+        if ((eol < data + size) && (*eol == '\n')) {
+            eol++;
+        }
+
+        // A section with no entries is added to right after its header.
+        if (key.empty()) {
+            if (!sections[current].count) {
+                sections[current].end = eol - data;
+            }
+            continue;
+        }
+
+        sections[current].end = eol - data;
+        sections[current].count++;
+        entries.push_back({ current, key, value });
+    }
+
+    // Group the entries by section, keeping them in file order.
+    std::stable_sort(entries.begin(), entries.end(), [](const BaseEntry &a, const BaseEntry &b) {
+        return a.section < b.section;
+    });
+    uint32_t first = 0;
+    for (BaseSection &s : sections) {
+        s.first = first;
+        first += s.count;
+    }
+}
+
+/**
+ * @brief Finds a section of the file being updated.
+ * @return The section, or null if the file has no header for it.
+ */
+const IniWriter::BaseSection *
+IniWriter::FindSection(
+    std::string_view section
+) const {
+    // Entries are written a section at a time, so this is usually the last one.
+    if ((lastSection < sections.size())
+            && IniNameEquals(sections[lastSection].name, section)) {
+        return &sections[lastSection];
+    }
+
+    for (size_t i = 0; i < sections.size(); i++) {
+        if (IniNameEquals(sections[i].name, section)) {
+            lastSection = i;
+            return &sections[i];
+        }
+    }
+
+    return nullptr;
+}
+
+/**
+ * @brief Finds the value of a key in the file being updated.
+ *
+ * If the key appears more than once, the last value is found, as that is the
+ * one which was read.
+ *
+ * @return The value, or null if the key is not in the file.
+ */
+const std::string_view *
+IniWriter::FindValue(
+    std::string_view section,
+    std::string_view key
+) const {
+    const BaseSection *sec = FindSection(section);
+    if (!sec) {
+        return nullptr;
+    }
+
+    for (uint32_t i = sec->first + sec->count; i > sec->first; i--) {
+        if (IniNameEquals(entries[i - 1].key, key)) {
+            return &entries[i - 1].value;
+        }
+    }
+
+    return nullptr;
+}
+
+/**
+ * @brief Writes each line of the given text, as SimpleIni did for comments.
+ *
+ * A trailing new line in the text gives an empty last line.
+ */
+void
+IniWriter::WriteLines(
+    std::string &dst,
+    const char *text
+) const {
+    if (!*text) {
+        return;
+    }
+
+    while (true) {
+        const char *eol = strchr(text, '\n');
+        if (!eol) {
+            dst.append(text);
+            dst.append(newLine);
+            return;
+        }
+
+        dst.append(text, eol - text);
+        dst.append(newLine);
+        text = eol + 1;
+    }
+}
+
+/**
+ * @brief Writes an entry line, and its comment.
+ */
+void
+IniWriter::WriteEntry(
+    std::string &dst,
+    std::string_view key,
+    std::string_view value,
+    const char *comment
+) const {
+    if (comment) {
+        dst.append(newLine);
+        WriteLines(dst, comment);
+    }
+
+    dst.append(key);
+    dst.append(" = ");
+    dst.append(value);
+    dst.append(newLine);
+}
+
+/**
+ * @brief Writes an entry to the INI file.
+ *
+ * When updating a file, an existing key has its value replaced, and a new key
+ * is added to the end of its section. Otherwise, a section header is written
+ * first if the entry is not in the same section as the last one.
+ *
+ * @param section The section of the entry.
+ * @param key The key of the entry.
+ * @param value The value of the entry.
+ * @param comment The comment to write above the entry, or null. Comments are
+ *                only written with new keys.
+ */
+void
+IniWriter::Write(
+    const char *section,
+    std::string_view key,
+    std::string_view value,
+    const char *comment
+) {
+    const BaseSection *existing = FindSection(section);
+    if (existing) {
+        const std::string_view *old = FindValue(section, key);
+        size_t start = old ? (old->data() - base) : existing->end;
+        size_t end = old ? (start + old->size()) : existing->end;
+        size_t pos = spliced.size();
+        if (old) {
+            spliced.append(value);
+        } else {
+            WriteEntry(spliced, key, value, comment);
+        }
+
+        // Keys added to a section one after another share a splice.
+        if (!old && !splices.empty() && splices.back().insert
+                && (splices.back().start == start)
+                && (splices.back().textPos + splices.back().textLen == pos)) {
+            splices.back().textLen += spliced.size() - pos;
+        } else {
+            splices.push_back({ start, end, pos, spliced.size() - pos, !old });
+        }
+        return;
+    }
+
+    std::string_view sec(section);
+    if (out.empty() || (std::string_view(out.data() + sectionPos, sectionLen) != sec)) {
+        if (!out.empty() || baseSize) {
+            out.append(newLine);
+            out.append(newLine);
+        }
+
+        out.append("[");
+        sectionPos = out.size();
+        sectionLen = sec.size();
+        out.append(sec);
+        out.append("]");
+        out.append(newLine);
+    }
+
+    WriteEntry(out, key, value, comment);
+}
+
+/**
+ * @brief Applies the changes to the file being updated, after which the file
+ *        data is no longer needed.
+ *
+ * Does nothing for a new file.
+ */
+void
+IniWriter::Finish() {
+    if (!base) {
+        return;
+    }
+
+    std::stable_sort(splices.begin(), splices.end(), [](const Splice &a, const Splice &b) {
+        return a.start < b.start;
+    });
+
+    std::string file;
+    file.reserve(baseSize + spliced.size() + out.size() + 4);
+    size_t pos = 0;
+    for (const Splice &s : splices) {
+        file.append(base + pos, s.start - pos);
+        if (s.insert && (s.start == baseSize) && !file.empty() && (file.back() != '\n')) {
+            // The last line of the file needs ending before we add to it, even
+            // if its value was just replaced.
+            file.append(newLine);
+        }
+        file.append(spliced, s.textPos, s.textLen);
+        pos = s.end;
+    }
+    file.append(base + pos, baseSize - pos);
+
+    if (!out.empty() && baseSize && (file.back() != '\n')) {
+        file.append(newLine);
+    }
+    file.append(out);
+
+    out.swap(file);
+    base = nullptr;
+    baseSize = 0;
+    sections.clear();
+    entries.clear();
+    splices.clear();
+    spliced.clear();
+}
+
+/**
+ * @brief Saves the INI file to the given path, replacing it in a single step.
+ * @return True if the file was saved.
+ */
+bool
+IniWriter::Save(
+    const std::string &path
+) {
+    Finish();
+    return WriteFileAtomic(path, out.data(), out.size());
+}
@@ -0,0 +1,52 @@
+/**
+ * @file Interpolation.cpp
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Implementation of member functions for the Interpolation class.
+ * @bug No known bugs.
+ */
+
+#include "Interpolation.h"
+
+#include "Ini.h"
+
+const char *const Interpolation::kNames[kCount] = {
+    "Step",
+    "Linear",
+    "Cubic"
+};
+
+/**
+ * @brief Converts the given name to an interpolation mode, ignoring case.
+ * @param name The name of the mode, as returned by Str().
+ * @param mode Returns the mode, if the name was valid.
+ * @return True if the name was valid.
+ */
+bool
+Interpolation::FromName(
+    std::string_view name,
+    t &mode
+) {
+    for (int i = 0; i < kCount; i++) {
+        if (IniNameEquals(name, kNames[i])) {
+            mode = static_cast<t>(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Converts the given interpolation mode to its name.
+ *
+ * The returned string must not be freed.
+ *
+ * @param mode The mode to convert.
+ */
+const char *
+Interpolation::Str(
+    t mode
+) {
+    ASSERT(mode < kCount);
+    return kNames[mode];
+}
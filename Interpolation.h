@@ -0,0 +1,42 @@
+/**
+ * @file Interpolation.h
+ * @author Andrew Spaulding (Kasplat)
+ * @brief A class-enum for the ways a leveled setting blends between levels.
+ * @bug No known bugs.
+ */
+
+#ifndef __SKYRIM_UNCAPPER_AE_INTERPOLATION_H__
+#define __SKYRIM_UNCAPPER_AE_INTERPOLATION_H__
+
+#include <string_view>
+
+/**
+ * @brief Encodes how a leveled setting finds the value of a level which lies
+ *        between two of its entries.
+ */
+class Interpolation {
+  public:
+    enum t {
+        /// @brief Uses the value of the closest lower level.
+        Step,
+
+        /// @brief Blends linearly between the closest lower and higher levels.
+        Linear,
+
+        /// @brief Blends along a monotone cubic curve, which is smooth but never
+        ///        overshoots the values on either side.
+        Cubic,
+
+        kCount
+    };
+
+  private:
+    /// @brief Used to convert a mode to its name in the INI file.
+    static const char *const kNames[kCount];
+
+  public:
+    static bool FromName(std::string_view name, t &mode);
+    static const char *Str(t mode);
+};
+
+#endif /* __SKYRIM_UNCAPPER_AE_INTERPOLATION_H__ */
@@ -0,0 +1,69 @@
+/**
+ * @file LeveledArena.h
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Holds the compiled storage of every leveled setting in one block.
+ * @bug No known bugs.
+ */
+
+#ifndef __SKYRIM_UNCAPPER_AE_LEVELED_ARENA_H__
+#define __SKYRIM_UNCAPPER_AE_LEVELED_ARENA_H__
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "ConfigCache.h"
+
+/**
+ * @brief A single block of 32-bit words, which the compiled leveled settings
+ *        are placed into one after another.
+ *
+ * Each list only keeps its offset and length into the arena. Lists which are
+ * read together are placed next to each other, so that a lookup in each of
+ * them touches as few cache lines as possible. The arena must not be changed
+ * once the lists have been bound to it.
+ */
+class LeveledArena {
+  private:
+    std::vector<uint32_t> words;
+
+  public:
+    /**
+     * @brief Empties the arena, and makes room for the given number of words.
+     */
+    inline void
+    Reset(
+        size_t size
+    ) {
+        std::vector<uint32_t>().swap(words);
+        words.reserve(size);
+    }
+
+    /**
+     * @brief Appends a value to the arena.
+     */
+    template <typename T>
+    inline void
+    Push(
+        T val
+    ) {
+        static_assert(sizeof(T) == sizeof(uint32_t), "Arena values must be one word.");
+        uint32_t word;
+        memcpy(&word, &val, sizeof(word));
+        words.push_back(word);
+    }
+
+    /// @brief Gets the words of the arena.
+    inline const uint32_t *Data(void) const { return words.data(); }
+
+    /// @brief Gets the number of words in the arena.
+    inline size_t Size(void) const { return words.size(); }
+
+    /// @brief Writes the arena to the settings cache.
+    inline void SaveCache(CacheWriter &cache) const { cache.Write(words); }
+
+    /// @brief Reads the arena from the settings cache.
+    inline bool LoadCache(CacheReader &cache) { return cache.Read(words); }
+};
+
+#endif /* __SKYRIM_UNCAPPER_AE_LEVELED_ARENA_H__ */
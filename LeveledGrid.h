@@ -0,0 +1,495 @@
+/**
+ * @file LeveledGrid.h
+ * @author Andrew Spaulding (Kasplat)
+ * @brief A setting whose value depends on both a skill level and the player
+ *        level.
+ * @bug No known bugs.
+ */
+
+#ifndef __SKYRIM_UNCAPPER_AE_LEVELED_GRID_H__
+#define __SKYRIM_UNCAPPER_AE_LEVELED_GRID_H__
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "Compare.h"
+#include "ConfigCache.h"
+#include "Ini.h"
+#include "Interpolation.h"
+#include "LeveledArena.h"
+
+/**
+ * @brief A grid of values, keyed by "skill,player" level pairs in the INI
+ *        file.
+ *
+ * The levels which appear in the entries form the rows and columns of the
+ * grid. Grid points which aren't listed use the default value. Between the
+ * points, the grid either steps to the closest lower point on each axis, or
+ * blends bilinearly between the four points around it.
+ *
+ * The grid is compiled into the sorted levels of each axis, followed by the
+ * value of each point. A lookup searches each axis for the closest lower
+ * level, and then loads that point, and in a linear grid the three points
+ * after it, which it blends. At most kMaxGridKeys levels per axis are kept,
+ * so a grid never takes more than a few KB.
+ */
+template <typename T>
+class LeveledGrid {
+    static_assert(std::is_floating_point<T>::value, "Grid values are blended, so must be floating point.");
+
+  private:
+    struct GridEntry {
+        uint32_t skill;
+        uint32_t player;
+        T item;
+    };
+
+    /// @brief The buffer size used to concat the section and subsection.
+    static const size_t kBufSize = 256;
+
+    /// @brief The most levels on either axis which may have entries.
+    static const size_t kMaxGridKeys = 32;
+
+    /// @brief The key which sets the interpolation mode of a grid.
+    static constexpr const char *kInterpolationKey = "Interpolation";
+
+    /**
+     * @brief The entries read from the INI file.
+     *
+     * Once compiled, these are sorted by skill level and then player level,
+     * and are kept so that the grid can be written back out.
+     */
+    std::vector<GridEntry> entries;
+
+    /// @brief The compiled grid, until it is placed in the arena.
+    std::vector<uint32_t> pending;
+
+    /// @brief The sorted skill levels of the columns, in the arena.
+    const uint32_t *skillKeys;
+
+    /// @brief The sorted player levels of the rows, in the arena just after
+    ///        the skill levels.
+    const uint32_t *playerKeys;
+
+    /// @brief The value of each point, by row, in the arena after the rows.
+    const uint32_t *points;
+
+    /// @brief The offset of the grid in the arena, in words.
+    uint32_t offset;
+
+    /// @brief The number of columns. Higher skill levels use the last one.
+    uint32_t skillCount;
+
+    /// @brief The number of rows. Higher player levels use the last one.
+    uint32_t playerCount;
+
+    /// @brief How the grid blends between its points.
+    Interpolation::t mode;
+
+    /// @brief Whether the mode was given in the INI file.
+    bool modeRead;
+
+    T defaultVal;
+
+    /**
+     * @brief Gets the sorted levels on one axis of the entries, starting at 0.
+     *
+     * Only the first kMaxGridKeys levels are kept.
+     */
+    std::vector<uint32_t>
+    Keys(
+        uint32_t GridEntry::*axis
+    ) {
+        std::vector<uint32_t> keys = { 0 };
+        for (auto &entry : entries) {
+            keys.push_back(entry.*axis);
+        }
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+        if (keys.size() > kMaxGridKeys) {
+            _WARNING("A grid may only have %zu levels on each axis. Higher levels are ignored.", kMaxGridKeys);
+            keys.resize(kMaxGridKeys);
+        }
+
+        return keys;
+    }
+
+    /**
+     * @brief Finds the index of the last key at or below the given level,
+     *        with a branch-free binary search. The first key must be 0.
+     */
+    static inline size_t
+    FindKey(
+        const uint32_t *keys,
+        size_t count,
+        unsigned int level
+    ) {
+        const uint32_t *base = keys;
+        while (count > 1) {
+            size_t half = count >> 1;
+            base = (base[half] <= level) ? (base + half) : base;
+            count -= half;
+        }
+
+        return base - keys;
+    }
+
+    /**
+     * @brief Gets the blend weight of a level between the i'th key and the
+     *        next, or 0 if it is past the last key.
+     */
+    static inline double
+    Weight(
+        const uint32_t *keys,
+        size_t count,
+        size_t i,
+        unsigned int level
+    ) {
+        if ((i + 1) == count) {
+            return 0;
+        }
+
+        return static_cast<double>(level - keys[i]) / static_cast<double>(keys[i + 1] - keys[i]);
+    }
+
+    /// @brief Converts a word of the arena back into a value.
+    static inline T
+    FromWord(
+        uint32_t word
+    ) {
+        T val;
+        memcpy(&val, &word, sizeof(val));
+        return val;
+    }
+
+    /**
+     * @brief Compiles the entries which were read in into the levels of each
+     *        axis and the value of each point.
+     *
+     * If a level pair appears more than once, the first entry is kept.
+     */
+    void
+    Compile() {
+        std::stable_sort(entries.begin(), entries.end(), [](const GridEntry &a, const GridEntry &b) {
+            return (a.skill < b.skill) || ((a.skill == b.skill) && (a.player < b.player));
+        });
+        auto last = std::unique(entries.begin(), entries.end(), [](const GridEntry &a, const GridEntry &b) {
+            return (a.skill == b.skill) && (a.player == b.player);
+        });
+        entries.erase(last, entries.end());
+
+        std::vector<uint32_t> skills = Keys(&GridEntry::skill);
+        std::vector<uint32_t> players = Keys(&GridEntry::player);
+        skillCount = static_cast<uint32_t>(skills.size());
+        playerCount = static_cast<uint32_t>(players.size());
+
+        pending = skills;
+        pending.insert(pending.end(), players.begin(), players.end());
+
+        size_t base = pending.size();
+        uint32_t default_word;
+        memcpy(&default_word, &defaultVal, sizeof(default_word));
+        pending.resize(base + skills.size() * players.size(), default_word);
+
+        // Entries past the kept levels were dropped from the axes.
+        for (auto &entry : entries) {
+            size_t s = FindKey(skills.data(), skills.size(), entry.skill);
+            size_t p = FindKey(players.data(), players.size(), entry.player);
+            if ((skills[s] == entry.skill) && (players[p] == entry.player)) {
+                memcpy(&pending[base + p * skills.size() + s], &entry.item, sizeof(uint32_t));
+            }
+        }
+    }
+
+  public:
+    LeveledGrid(
+    ) : skillKeys(nullptr),
+        playerKeys(nullptr),
+        points(nullptr),
+        offset(0),
+        skillCount(0),
+        playerCount(0),
+        mode(Interpolation::Step),
+        modeRead(false),
+        defaultVal(0)
+    {}
+
+    /**
+     * @brief Clears the grid, so that a new configuration can be read in.
+     * @param val The value of the points with no entry.
+     */
+    void
+    BeginRead(
+        T val
+    ) {
+        defaultVal = val;
+        mode = Interpolation::Step;
+        modeRead = false;
+        entries.clear();
+        pending.clear();
+    }
+
+    /**
+     * @brief Adds an entry read from the INI file to the grid.
+     *
+     * Entries are only gathered here, and compiled once the whole file has
+     * been read. If the mode appears more than once, the first one is kept.
+     *
+     * @param key The key of the entry, which is the skill level and the
+     *            player level separated by a comma, or the key which sets the
+     *            interpolation mode.
+     * @param value The value of the entry.
+     * @return True if the key was a level pair or the mode.
+     */
+    bool
+    ReadEntry(
+        std::string_view key,
+        std::string_view value
+    ) {
+        if (IniNameEquals(key, kInterpolationKey)) {
+            if (modeRead) {
+                return true;
+            } else if (!Interpolation::FromName(value, mode)) {
+                _WARNING("Unknown interpolation mode %.*s.", (int)value.size(), value.data());
+                return true;
+            }
+
+            modeRead = true;
+            if (mode == Interpolation::Cubic) {
+                _WARNING("Grids can't use Cubic interpolation, so Linear is used instead.");
+                mode = Interpolation::Linear;
+            }
+            return true;
+        }
+
+        size_t comma = key.find(',');
+        if (comma == std::string_view::npos) {
+            return false;
+        }
+
+        std::string_view skill_key = key.substr(0, comma);
+        std::string_view player_key = key.substr(comma + 1);
+        while (!skill_key.empty() && ((skill_key.back() == ' ') || (skill_key.back() == '\t'))) {
+            skill_key.remove_suffix(1);
+        }
+
+        uint32_t skill, player;
+        if (skill_key.empty() || (ParseIniNumber(skill_key, skill) != skill_key.size())
+                || player_key.empty() || (ParseIniNumber(player_key, player) != player_key.size())) {
+            return false;
+        }
+
+        entries.push_back({ skill, player, ParseIniValue(value, defaultVal) });
+        return true;
+    }
+
+    /**
+     * @brief Finishes reading in the grid.
+     *
+     * The grid can't be used until it has been placed in an arena and bound
+     * to it.
+     */
+    void
+    EndRead() {
+        Compile();
+    }
+
+    /// @brief Gets the number of words the compiled grid takes in an arena.
+    inline size_t ArenaSize(void) { return pending.size(); }
+
+    /**
+     * @brief Appends the compiled grid to the given arena.
+     *
+     * The skill levels are written first, then the player levels, and then
+     * the value of each point.
+     */
+    void
+    Place(
+        LeveledArena &arena
+    ) {
+        offset = static_cast<uint32_t>(arena.Size());
+        for (uint32_t word : pending) {
+            arena.Push(word);
+        }
+
+        std::vector<uint32_t>().swap(pending);
+    }
+
+    /**
+     * @brief Points the grid at its storage in the given arena.
+     *
+     * The storage is checked, as it may have been read from the cache.
+     *
+     * @return True if the grid is valid.
+     */
+    bool
+    Bind(
+        const LeveledArena &arena
+    ) {
+        skillKeys = playerKeys = points = nullptr;
+
+        if (!skillCount || (skillCount > kMaxGridKeys)
+                || !playerCount || (playerCount > kMaxGridKeys)
+                || (mode >= Interpolation::kCount)) {
+            return false;
+        }
+
+        size_t size = static_cast<size_t>(skillCount) + playerCount + skillCount * playerCount;
+        if ((offset > arena.Size()) || (arena.Size() - offset < size)) {
+            return false;
+        }
+
+        // Each axis must start at 0 and be strictly ascending.
+        const uint32_t *s = arena.Data() + offset;
+        const uint32_t *p = s + skillCount;
+        if (s[0] || p[0]) {
+            return false;
+        }
+        for (size_t i = 1; i < skillCount; i++) {
+            if (s[i] <= s[i - 1]) {
+                return false;
+            }
+        }
+        for (size_t i = 1; i < playerCount; i++) {
+            if (p[i] <= p[i - 1]) {
+                return false;
+            }
+        }
+
+        skillKeys = s;
+        playerKeys = p;
+        points = p + playerCount;
+        return true;
+    }
+
+    /**
+     * @brief Saves the entries of the grid to the given INI file.
+     *
+     * An empty grid is not written out. A grid which the file being updated
+     * already has is left as it is.
+     *
+     * @param ini The INI file to save the content to.
+     * @param sec The section to save the configuration to.
+     * @param subsec The subsection to save the configuration to.
+     * @param comment The comment to add to the top of the section.
+     */
+    void
+    SaveConfig(
+        IniWriter &ini,
+        const char *sec,
+        const char *subsec,
+        const char *comment
+    ) {
+        char buf[kBufSize];
+        auto res = sprintf_s(buf, "%s%s", sec, subsec);
+        ASSERT((0 < res) && (static_cast<size_t>(res) < kBufSize));
+        if (entries.empty() || ini.HasSection(buf)) {
+            return;
+        }
+
+        if (mode != Interpolation::Step) {
+            SaveIniValue(ini, buf, kInterpolationKey, std::string(Interpolation::Str(mode)), comment);
+            comment = NULL;
+        }
+
+        char key[32];
+        for (auto &entry : entries) {
+            auto mid = std::to_chars(key, key + sizeof(key), entry.skill);
+            ASSERT(mid.ec == std::errc());
+            *mid.ptr = ',';
+            auto end = std::to_chars(mid.ptr + 1, key + sizeof(key), entry.player);
+            ASSERT(end.ec == std::errc());
+
+            SaveIniValue(ini, buf, std::string_view(key, end.ptr - key), entry.item, comment);
+            comment = NULL;
+        }
+    }
+
+    /**
+     * @brief Writes the entries of the grid, and where its table is in the
+     *        arena, to the settings cache. The arena itself is cached
+     *        separately.
+     */
+    void
+    SaveCache(
+        CacheWriter &cache
+    ) {
+        cache.Write(entries);
+        cache.Write(static_cast<uint32_t>(mode));
+        cache.Write(offset);
+        cache.Write(skillCount);
+        cache.Write(playerCount);
+    }
+
+    /**
+     * @brief Reads the grid from the settings cache. The grid must then be
+     *        bound to the arena.
+     * @return True if the grid was read.
+     */
+    bool
+    LoadCache(
+        CacheReader &cache
+    ) {
+        uint32_t m;
+        if (!cache.Read(entries) || !cache.Read(m) || !cache.Read(offset)
+                || !cache.Read(skillCount) || !cache.Read(playerCount)) {
+            return false;
+        }
+
+        mode = static_cast<Interpolation::t>(m);
+        return true;
+    }
+
+    /// @brief Checks if the grid has no entries, and so is the default everywhere.
+    inline bool Empty(void) const { return entries.empty(); }
+
+    /**
+     * @brief Gets the value of the grid at the given levels.
+     *
+     * Levels past the last point on an axis use the value of that point.
+     *
+     * @param skill_level The skill level to get the value of.
+     * @param player_level The player level to get the value of.
+     * @return The associated value.
+     */
+    inline T
+    Get(
+        unsigned int skill_level,
+        unsigned int player_level
+    ) {
+        ASSERT(points);
+        size_t s = FindKey(skillKeys, skillCount, skill_level);
+        size_t p = FindKey(playerKeys, playerCount, player_level);
+        const uint32_t *row = &points[p * skillCount + s];
+        if (mode == Interpolation::Step) {
+            return FromWord(row[0]);
+        }
+
+        // A weight of 0 never reads the next point, which may not exist.
+        double sx = Weight(skillKeys, skillCount, s, skill_level);
+        double py = Weight(playerKeys, playerCount, p, player_level);
+        double val = FromWord(row[0]);
+        if (sx > 0) {
+            val += sx * (FromWord(row[1]) - val);
+        }
+        if (py > 0) {
+            double above = FromWord(row[skillCount]);
+            if (sx > 0) {
+                above += sx * (FromWord(row[skillCount + 1]) - above);
+            }
+            val += py * (above - val);
+        }
+
+        return static_cast<T>(val);
+    }
+};
+
+#endif /* __SKYRIM_UNCAPPER_AE_LEVELED_GRID_H__ */
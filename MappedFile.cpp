@@ -0,0 +1,96 @@
+/**
+ * @file MappedFile.cpp
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Windows implementation of read-only file mappings.
+ * @bug No known bugs.
+ */
+
+#include "MappedFile.h"
+
+#include <Windows.h>
+
+/**
+ * @brief Maps the file at the given path into memory.
+ *
+ * Any file which was previously opened is closed first.
+ *
+ * @param path The path of the file to map.
+ * @return Ok on success, NotFound if the file does not exist, or Failed.
+ */
+MappedFile::Status
+MappedFile::Open(
+    const char *path
+) {
+    Close();
+
+    // Other programs must still be able to save over the file while it is
+    // mapped, such as a text editor when hot reloading is enabled.
+    HANDLE f = CreateFileA(
+        path,
+        GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        NULL,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        NULL
+    );
+    if (f == INVALID_HANDLE_VALUE) {
+        DWORD err = GetLastError();
+        return ((err == ERROR_FILE_NOT_FOUND) || (err == ERROR_PATH_NOT_FOUND))
+            ? NotFound : Failed;
+    }
+    file = f;
+
+    LARGE_INTEGER len;
+    FILETIME write_time;
+    if (!GetFileSizeEx(f, &len) || !GetFileTime(f, NULL, NULL, &write_time)) {
+        Close();
+        return Failed;
+    }
+    modified = (static_cast<uint64_t>(write_time.dwHighDateTime) << 32)
+             | write_time.dwLowDateTime;
+
+    // Empty files can't be mapped, but there's nothing to read anyway.
+    if (len.QuadPart == 0) {
+        return Ok;
+    }
+
+    mapping = CreateFileMappingA(f, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) {
+        Close();
+        return Failed;
+    }
+
+    data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!data) {
+        Close();
+        return Failed;
+    }
+
+    size = static_cast<size_t>(len.QuadPart);
+    return Ok;
+}
+
+/**
+ * @brief Unmaps and closes the file, if one is open.
+ */
+void
+MappedFile::Close() {
+    if (data) {
+        UnmapViewOfFile(data);
+    }
+
+    if (mapping) {
+        CloseHandle(mapping);
+    }
+
+    if (file) {
+        CloseHandle(file);
+    }
+
+    file = nullptr;
+    mapping = nullptr;
+    data = nullptr;
+    size = 0;
+    modified = 0;
+}
@@ -0,0 +1,59 @@
+/**
+ * @file MappedFile.h
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Read-only memory mapping of a file.
+ * @bug No known bugs.
+ */
+
+#ifndef __SKYRIM_UNCAPPER_AE_MAPPED_FILE_H__
+#define __SKYRIM_UNCAPPER_AE_MAPPED_FILE_H__
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Maps a file into memory for reading, and unmaps it on destruction.
+ */
+class MappedFile {
+  public:
+    enum Status {
+        Ok,
+        NotFound,
+        Failed
+    };
+
+  private:
+    void *file;
+    void *mapping;
+    const char *data;
+    size_t size;
+    uint64_t modified;
+
+  public:
+    MappedFile(
+    ) : file(nullptr),
+        mapping(nullptr),
+        data(nullptr),
+        size(0),
+        modified(0)
+    {}
+
+    ~MappedFile() { Close(); }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    Status Open(const char *path);
+    void Close(void);
+
+    /// @brief Gets the contents of the file. Null if the file is empty.
+    inline const char *Data(void) const { return data; }
+
+    /// @brief Gets the size of the file, in bytes.
+    inline size_t Size(void) const { return size; }
+
+    /// @brief Gets the last write time of the file, as a Windows file time.
+    inline uint64_t Modified(void) const { return modified; }
+};
+
+#endif /* __SKYRIM_UNCAPPER_AE_MAPPED_FILE_H__ */
@@ -0,0 +1,192 @@
+/**
+ * @file NameTable.h
+ * @author Andrew Spaulding (Kasplat)
+ * @brief A perfect hash table from INI names to values.
+ * @bug No known bugs.
+ */
+
+#ifndef __SKYRIM_UNCAPPER_AE_NAME_TABLE_H__
+#define __SKYRIM_UNCAPPER_AE_NAME_TABLE_H__
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+
+#include "Compare.h"
+#include "Ini.h"
+
+/**
+ * @brief Maps a fixed set of case-insensitive names to values.
+ *
+ * All the names are added up front, and then Build() finds a displacement for
+ * each bucket of names such that no two names share a slot (hash and
+ * displace). A lookup is then two hashes, one slot, and one name compare,
+ * no matter how many names are in the table.
+ */
+template <typename V>
+class NameTable {
+  private:
+    struct Entry {
+        std::string name;
+        V value;
+    };
+
+    /// @brief Marks an unused slot.
+    static constexpr uint32_t kEmpty = UINT32_MAX;
+
+    /// @brief The number of displacements tried for a bucket before growing.
+    static constexpr uint32_t kMaxDisplacement = 1024;
+
+    std::vector<Entry> entries;
+    std::vector<uint32_t> displacements;
+    std::vector<uint32_t> slots;
+
+    /**
+     * @brief Hashes a name with FNV-1a, folding ASCII letters to lower case.
+     */
+    static uint32_t
+    Hash(
+        std::string_view name,
+        uint32_t seed
+    ) {
+        uint32_t h = 2166136261U ^ (seed * 0x9E3779B9U);
+        for (char c : name) {
+            if (('A' <= c) && (c <= 'Z')) {
+                c = c - 'A' + 'a';
+            }
+
+            h = (h ^ static_cast<unsigned char>(c)) * 16777619U;
+        }
+
+        return h ^ (h >> 15);
+    }
+
+    /**
+     * @brief Attempts to place every entry with the given table sizes.
+     * @return True if a displacement was found for every bucket.
+     */
+    bool
+    TryBuild(
+        size_t bucket_count,
+        size_t slot_count
+    ) {
+        std::vector<std::vector<uint32_t>> buckets(bucket_count);
+        for (uint32_t i = 0; i < entries.size(); i++) {
+            buckets[Hash(entries[i].name, 0) % bucket_count].push_back(i);
+        }
+
+        // Place the largest buckets first, while the table is still empty.
+        std::vector<uint32_t> order(bucket_count);
+        for (uint32_t i = 0; i < bucket_count; i++) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return buckets[a].size() > buckets[b].size();
+        });
+
+        displacements.assign(bucket_count, 0);
+        slots.assign(slot_count, kEmpty);
+        std::vector<uint32_t> placed;
+        for (uint32_t b : order) {
+            if (buckets[b].empty()) {
+                break;
+            }
+
+            bool found = false;
+            for (uint32_t d = 1; !found && (d <= kMaxDisplacement); d++) {
+                placed.clear();
+                found = true;
+                for (uint32_t e : buckets[b]) {
+                    uint32_t s = Hash(entries[e].name, d) & (slot_count - 1);
+                    if ((slots[s] != kEmpty)
+                            || (std::find(placed.begin(), placed.end(), s) != placed.end())) {
+                        found = false;
+                        break;
+                    }
+                    placed.push_back(s);
+                }
+
+                if (found) {
+                    displacements[b] = d;
+                    for (size_t i = 0; i < placed.size(); i++) {
+                        slots[placed[i]] = buckets[b][i];
+                    }
+                }
+            }
+
+            if (!found) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+  public:
+    /**
+     * @brief Adds a name to the table. Build() must be called again after.
+     *
+     * Names must be unique, ignoring case.
+     */
+    void
+    Add(
+        std::string_view name,
+        V value
+    ) {
+        entries.push_back({ std::string(name), value });
+    }
+
+    /**
+     * @brief Builds the hash table from the names which have been added.
+     */
+    void
+    Build() {
+        if (entries.empty()) {
+            displacements.clear();
+            slots.clear();
+            return;
+        }
+
+        size_t slot_count = 1;
+        while (slot_count < entries.size() * 2) {
+            slot_count <<= 1;
+        }
+
+        size_t bucket_count = MAX(entries.size() / 4, static_cast<size_t>(1));
+        while (!TryBuild(bucket_count, slot_count)) {
+            // Only a repeated name can keep failing as the table grows.
+            if (slot_count > (entries.size() << 8)) {
+                HALT("Failed to build name table; names must be unique.");
+            }
+            slot_count <<= 1;
+        }
+    }
+
+    /// @brief Checks if the table has been built with any names.
+    inline bool IsEmpty(void) const { return slots.empty(); }
+
+    /**
+     * @brief Finds the value of the given name, ignoring case.
+     * @return The value, or null if the name is not in the table.
+     */
+    const V *
+    Find(
+        std::string_view name
+    ) const {
+        if (slots.empty()) {
+            return nullptr;
+        }
+
+        uint32_t d = displacements[Hash(name, 0) % displacements.size()];
+        uint32_t e = slots[Hash(name, d) & (slots.size() - 1)];
+        if ((e == kEmpty) || !IniNameEquals(name, entries[e].name)) {
+            return nullptr;
+        }
+
+        return &entries[e].value;
+    }
+};
+
+#endif /* __SKYRIM_UNCAPPER_AE_NAME_TABLE_H__ */
@@ -0,0 +1,162 @@
+/**
+ * @file PerkSchedule.cpp
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Implementation of the perk prefix-sum table.
+ * @bug No known bugs.
+ */
+
+#include "PerkSchedule.h"
+
+#include <algorithm>
+
+#include "Settings.h"
+#include "Compare.h"
+#include "ConfigCache.h"
+
+/**
+ * @brief Converts a perk value to a fixed-point rate.
+ *
+ * Negative perk values are treated as zero.
+ */
+uint64_t
+PerkSchedule::ToRate(
+    float item
+) {
+    double val = item;
+    return (val > 0)
+        ? static_cast<uint64_t>(MIN(static_cast<double>(kMaxRate), val * kScale + 0.5))
+        : 0;
+}
+
+/**
+ * @brief Compiles the given leveled perk setting into a prefix-sum table.
+ *
+ * The dense table is built from the value of every level, so an interpolated
+ * perk curve is summed level by level. Past the dense table, the totals are
+ * kept as runs of levels which award the same number of perks. An
+ * interpolated curve may start a new run at every level until its last
+ * entry, so those runs are only kept up to the highest level the player can
+ * reach.
+ *
+ * @param perks The perks awarded at each level. Must contain level 0.
+ */
+void
+PerkSchedule::Compile(
+    LeveledSetting<float> &perks
+) {
+    ASSERT(perks.Size() > 0);
+    ASSERT(perks.LevelAt(0) == 0);
+
+    segments.clear();
+    dense.clear();
+
+    // Past the final entry the totals grow linearly, so there's no point
+    // in storing them.
+    size_t last = perks.LevelAt(perks.Size() - 1);
+    size_t dense_levels = MIN(kMaxDenseLevels, last + 1);
+    dense.reserve(dense_levels);
+
+    uint64_t acc = 0;
+    for (size_t level = 0; level < dense_levels; level++) {
+        acc += ToRate(perks.Get(static_cast<unsigned int>(level)));
+        dense.push_back(acc / kScale);
+    }
+
+    // Convert each run of levels after the dense table to fixed-point,
+    // tracking the sum of all previous levels.
+    unsigned int start = static_cast<unsigned int>(dense_levels);
+    segments.push_back({ start, ToRate(perks.Get(start)), acc });
+    auto add = [this](unsigned int level, uint64_t rate) {
+        const Segment &prev = segments.back();
+        if (rate != prev.rate) {
+            uint64_t base = prev.base + static_cast<uint64_t>(level - prev.level) * prev.rate;
+            segments.push_back({ level, rate, base });
+        }
+    };
+
+    unsigned int blend_end = MIN(perks.BlendEnd(), static_cast<unsigned int>(MAX_PLAYER_LEVEL) + 1);
+    for (unsigned int level = start + 1; level < blend_end; level++) {
+        add(level, ToRate(perks.Get(level)));
+    }
+
+    for (size_t i = 0; i < perks.Size(); i++) {
+        unsigned int level = perks.LevelAt(i);
+        if ((level > start) && (level >= blend_end)) {
+            add(level, ToRate(perks.ItemAt(i)));
+        }
+    }
+}
+
+/**
+ * @brief Writes the compiled schedule to the settings cache.
+ */
+void
+PerkSchedule::SaveCache(
+    CacheWriter &cache
+) {
+    cache.Write(segments);
+    cache.Write(dense);
+}
+
+/**
+ * @brief Reads the compiled schedule from the settings cache.
+ * @return True if a valid schedule was read.
+ */
+bool
+PerkSchedule::LoadCache(
+    CacheReader &cache
+) {
+    return cache.Read(segments) && cache.Read(dense)
+        && !dense.empty() && (dense.size() <= kMaxDenseLevels)
+        && !segments.empty() && (segments[0].level == dense.size());
+}
+
+/**
+ * @brief Gets the fixed-point number of perks awarded for every level up to
+ *        and including the given level.
+ */
+uint64_t
+PerkSchedule::GetTotal(
+    unsigned int level
+) {
+    ASSERT(segments.size() > 0);
+
+    auto seg = std::upper_bound(
+        segments.begin(),
+        segments.end(),
+        level,
+        [](unsigned int l, const Segment &s) { return l < s.level; }
+    );
+
+    ASSERT(seg != segments.begin());
+    seg--;
+
+    return seg->base + static_cast<uint64_t>(level - seg->level + 1) * seg->rate;
+}
+
+/**
+ * @brief Determines how many perks are awarded for reaching the given level.
+ *
+ * Fractional perks carry over between levels, so the result is the
+ * difference of the whole number of perks awarded up to this level and up
+ * to the previous one.
+ *
+ * @param level The new level of the player.
+ * @return The number of perks gained.
+ */
+unsigned int
+PerkSchedule::GetDelta(
+    unsigned int level
+) {
+    ASSERT(dense.size() > 0);
+
+    if (level < dense.size()) {
+        uint64_t prev = (level > 0) ? dense[level - 1] : 0;
+        return static_cast<unsigned int>(dense[level] - prev);
+    }
+
+    // The segments start where the dense table ends.
+    uint64_t total = GetTotal(level) / kScale;
+    uint64_t prev = ((level - 1) < dense.size()) ? dense[level - 1] : (GetTotal(level - 1) / kScale);
+    return static_cast<unsigned int>(total - prev);
+}
@@ -0,0 +1,63 @@
+/**
+ * @file PerkSchedule.h
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Compiles the leveled perk setting into a prefix-sum table.
+ * @bug No known bugs.
+ */
+
+#ifndef __SKYRIM_UNCAPPER_AE_PERK_SCHEDULE_H__
+#define __SKYRIM_UNCAPPER_AE_PERK_SCHEDULE_H__
+
+#include <cstdint>
+#include <vector>
+
+template <typename T> class LeveledSetting;
+class CacheWriter;
+class CacheReader;
+
+/**
+ * @brief Tracks the total number of perks awarded up to each level.
+ *
+ * Perk values are accumulated in decimal fixed-point, so that fractional
+ * perks (such as 0.2 per level) add up to exactly one perk when they should,
+ * rather than drifting with float rounding.
+ */
+class PerkSchedule {
+  private:
+    /// @brief Fixed-point scale applied to each perk value (6 decimal places).
+    static const uint64_t kScale = 1000000;
+
+    /// @brief Per-level values are clamped to this, as the pool is a byte.
+    static const uint64_t kMaxRate = 256 * kScale;
+
+    /// @brief The maximum number of levels stored in the dense table.
+    static const size_t kMaxDenseLevels = 4096;
+
+    /**
+     * @brief A run of levels past the dense table which all award the same
+     *        number of perks.
+     *
+     * The base is the fixed-point sum of every level before this segment.
+     */
+    struct Segment {
+        unsigned int level;
+        uint64_t rate;
+        uint64_t base;
+    };
+
+    std::vector<Segment> segments;
+
+    /// @brief Whole number of perks awarded in total up to each level.
+    std::vector<uint64_t> dense;
+
+    static uint64_t ToRate(float item);
+    uint64_t GetTotal(unsigned int level);
+
+  public:
+    void Compile(LeveledSetting<float> &perks);
+    void SaveCache(CacheWriter &cache);
+    bool LoadCache(CacheReader &cache);
+    unsigned int GetDelta(unsigned int level);
+};
+
+#endif /* __SKYRIM_UNCAPPER_AE_PERK_SCHEDULE_H__ */
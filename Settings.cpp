@@ -12,281 +12,422 @@
 
 #include "Settings.h"
 #include "Compare.h"
+#include "MappedFile.h"
 #include "Utilities.h"
 
 /// @brief Global settings manager, used throughout this plugin.
 Settings settings;
 
-// Comment on each leveled setting description.
-#define LEVELED_SETTING_NOTE\
-    "# If a specific level is not specified, then the\n"\
-    "# value for the closest lower level is used."
-
-const char *const Settings::GeneralSettings::kSection = "General";
-const char *const Settings::GeneralSettings::kVersionDesc =
-    "# Do not manually change this field. Doing so can prevent this INI file\n"
-    "# from updating with new versions.";
-const char *const Settings::GeneralSettings::kEnableSkillCapsDesc =
-    "# Enables the code which uncap skill levels.";
-const char *const Settings::GeneralSettings::kEnableSkillFormulaCapsDesc =
-    "# Enables the code which cap all skill formulas.";
-const char *const Settings::GeneralSettings::kEnableEnchantingPatchDesc =
-    "# Enables the code which patches to the enchantment charge cost "
-    "calculation.";
-const char *const Settings::GeneralSettings::kEnableSkillExpMultsDesc =
-    "# Enables the code which applies the skill experience multipliers.";
-const char *const Settings::GeneralSettings::kEnableLevelExpMultsDesc =
-    "# Enables the code which applies the level experience multipliers.";
-const char *const Settings::GeneralSettings::kEnablePerkPointsDesc =
-    "# Enables the code which modifies perk point gain.";
-const char *const Settings::GeneralSettings::kEnableAttributePointsDesc =
-    "# Enables the code which modifies attribute point gain.";
-const char *const Settings::GeneralSettings::kEnableLegendaryDesc =
-    "# Enables the code which modifies the legendary skill system.";
-
-const char *const Settings::EnchantSettings::kSection = "Enchanting";
-const char *const Settings::EnchantSettings::kMagnitudeLevelCapDesc =
-    "# Sets the formula cap for the enchanting magnitude calculation.\n"
-    "# This value is also capped by the enchanting skill formula cap.";
-const char *const Settings::EnchantSettings::kChargeLevelCapDesc =
-    "# Sets the formula cap for the enchanting weapon charge calculation.\n"
-    "# The formula breaks above level 199, so values above that will be ignored.\n"
-    "# This value is also capped by the enchanting skill formula cap.";
-const char *const Settings::EnchantSettings::kUseLinearChargeFormulaDesc =
-    "# Forces the game to use a linear formula for level-based weapon\n"
-    "# charge calculation. Useful if the charge cap is close to 199, as the\n"
-    "# later level-ups in enchanting will give massive boosts to the number\n"
-    "# of charge points available.";
-
-const char *const Settings::LegendarySettings::kSection = "LegendarySkill";
-const char *const Settings::LegendarySettings::kKeepSkillLevelDesc =
-    "# This option determines whether the legendary feature will reset the\n"
-    "# skill level. Setting this option to true will make the option\n"
-    "# \"iSkillLevelAfterLegendary\" have no effect.";
-const char *const Settings::LegendarySettings::kHideButtonDesc =
-    "# This option determines whether to hide the legendary button in \"Skills\"\n"
-    "# menu when you meet the requirements to legendary a skill.\n"
-    "# If you set \"iSkillLevelEnableLegendary\" to below 100, the legendary\n"
-    "# button will not show up, but you can make skills legendary normally\n"
-    "# by pressing SPACE.";
-const char *const Settings::LegendarySettings::kSkillLevelEnableDesc =
-    "# This option determines the skill level required to make a skill legendary.";
-const char *const Settings::LegendarySettings::kSkillLevelAfterDesc =
-    "# This option determines the level of a skill after making it legendary.\n"
-    "# Setting this option to 0 will reset the skill level to default level.";
-
-const char *const Settings::kSkillCapsDesc =
-    "# Set the skill level cap. This option determines the upper limit of\n"
-    "# skill level you can reach.";
-const char *const Settings::kSkillFormulaCapsDesc =
-    "# Set the skill formula cap. This option determines the upper limit of\n"
-    "# skill level used in the calculation of all kinds of magic effects.";
-const char *const Settings::kSkillExpGainMultsDesc =
-    "# Set the skill experience gained multiplier. The skill experience\n"
-    "# you gained actually = The final calculated experience value right\n"
-    "# before it is given to the character after any experience\n"
-    "# modification * SkillExpGainMult * Corresponding\n"
-    "# Sub-SkillExpGainMult listed below.";
-const char *const Settings::kSkillExpGainMultsWithPCLevelDesc =
-    "# All the subsections of SkillExpGainMults below allow to set an\n"
-    "# additional multiplier depending on CHARACTER LEVEL, independantly\n"
-    "# for each skill.";
-const char *const Settings::kSkillExpGainMultsWithSkillsDesc =
-    "# All the subsections of SkillExpGainMults below allow to set an\n"
-    "# additional multiplier depending on BASE SKILL LEVEL, independantly\n"
-    "# for each skill.";
-const char *const Settings::kLevelSkillExpMultsDesc =
-    "# Set the skill experience to PC experience multipliers. When you\n"
-    "# level up a skill, the PC experience you gained actually = Current\n"
-    "# base skill level * LevelSkillExpMults * Corresponding "
-    "# Sub-LevelSkillExpMults listed below.";
-const char *const Settings::kLevelSkillExpMultsWithPCLevelDesc =
-    "# All the subsections of LevelSkillExpMults below allow to set an\n"
-    "# additional multipliers depending on CHARACTER LEVEL, independantly\n"
-    "# for each skill.";
-const char *const Settings::kLevelSkillExpMultsWithSkillsDesc =
-    "# All the subsections of LevelSkillExpMults below allow to set an\n"
-    "# additional multipliers depending on BASE SKILL LEVEL, independantly\n"
-    "# for each skill.";
-const char *const Settings::kPerksAtLevelUpDesc =
-    "# Set the number of perks gained at each level up.\n"
-    LEVELED_SETTING_NOTE;
-const char *const Settings::kHealthAtLevelUpDesc =
-    "# Set the number of health gained at each health level up.\n"
-    LEVELED_SETTING_NOTE;
-const char *const Settings::kHealthAtMagickaLevelUpDesc =
-    "# Set the number of health gained at each magicka level up.\n"
-    LEVELED_SETTING_NOTE;
-const char *const Settings::kHealthAtStaminaLevelUpDesc =
-    "# Set the number of health gained at each stamina level up.\n"
-    LEVELED_SETTING_NOTE;
-const char *const Settings::kMagickaAtLevelUpDesc =
-    "# Set the number of magicka gained at each magicka level up.\n"
-    LEVELED_SETTING_NOTE;
-const char *const Settings::kMagickaAtHealthLevelUpDesc =
-    "# Set the number of magicka gained at each health level up.\n"
-    LEVELED_SETTING_NOTE;
-const char *const Settings::kMagickaAtStaminaLevelUpDesc =
-    "# Set the number of magicka gained at each stamina level up.\n"
-    LEVELED_SETTING_NOTE;
-const char *const Settings::kStaminaAtLevelUpDesc =
-    "# Set the number of stamina gained at each stamina level up.\n"
-    LEVELED_SETTING_NOTE;
-const char *const Settings::kStaminaAtHealthLevelUpDesc =
-    "# Set the number of stamina gained at each health level up.\n"
-    LEVELED_SETTING_NOTE;
-const char *const Settings::kStaminaAtMagickaLevelUpDesc =
-    "# Set the number of stamina gained at each magicka level up.\n"
-    LEVELED_SETTING_NOTE;
-const char *const Settings::kCarryWeightAtHealthLevelUpDesc =
-    "# Set the number of carryweight gained at each health level up.\n"
-    LEVELED_SETTING_NOTE;
-const char *const Settings::kCarryWeightAtMagickaLevelUpDesc =
-    "# Set the number of carryweight gained at each magicka level up.\n"
-    LEVELED_SETTING_NOTE;
-const char *const Settings::kCarryWeightAtStaminaLevelUpDesc =
-    "# Set the number of carryweight gained at each stamina level up.\n"
-    LEVELED_SETTING_NOTE;
-
-/**
- * @brief Reads in the general settings section
+/// @brief Room to reserve when writing a new INI, enough for the defaults.
+static const size_t kSaveReserve = 16 * 1024;
+
+/// @brief Lists the section of a setting, so duplicates can be caught.
+#define SETTINGS_SECTION_NAME(kind, member, section, ...) section,
+
+/**
+ * @brief The section of every setting. Leveled lists and grids for each skill
+ *        are listed by the prefix of their sections.
+ */
+static constexpr const char *kSchemaSections[] = {
+    SETTINGS_SCHEMA(
+        SETTINGS_SECTION_NAME,
+        SETTINGS_SECTION_NAME,
+        SETTINGS_SECTION_NAME,
+        SETTINGS_SECTION_NAME,
+        SETTINGS_SECTION_NAME
+    )
+};
+static_assert(IniNamesUnique(kSchemaSections), "Duplicate section in the settings schema.");
+
+/**
+ * @brief Writes out the settings as an INI file at the given path.
+ *
+ * The settings are written straight into one buffer in schema order, and the
+ * file is then replaced with a single write. If there is already an INI file,
+ * it is updated instead: only new keys and changed values are written, and
+ * everything else in the file, including comments, is kept.
+ *
+ * @param path The path to save the file to.
+ * @param file The existing INI file, which is closed before it is replaced.
+ */
+bool
+Settings::SaveConfig(
+    const std::string &path,
+    MappedFile &file
+) {
+    _MESSAGE("Saving config file...");
+
+    IniWriter ini = file.Data() ? IniWriter(file.Data(), file.Size()) : IniWriter(kSaveReserve);
+
+    // Reset the general information.
+    general.version.Set(CONFIG_VERSION);
+    ForEachSetting([&](auto setting, const char *comment) {
+        (this->*setting).SaveConfig(ini, comment);
+    });
+
+    // Save the generated INI file. The old file can't be replaced while we
+    // still have it mapped.
+    ini.Finish();
+    file.Close();
+    if (!ini.Save(path)) {
+        _ERROR("Can't save config file %s", path.c_str());
+        return false;
+    } else {
+        _MESSAGE("Config file saved.");
+        return true;
+    }
+}
+
+/**
+ * @brief Resets every setting, so that a new configuration can be read in.
  */
 void
-Settings::GeneralSettings::ReadConfig(
-    CSimpleIniA &ini
+Settings::BeginRead() {
+    ForEachSetting([this](auto setting, const char *) {
+        (this->*setting).BeginRead();
+    });
+}
+
+/**
+ * @brief Reads an INI entry into a setting with a single section.
+ */
+template <typename T>
+bool
+Settings::ReadSection(
+    void *setting,
+    SkillSlot::t slot,
+    std::string_view key,
+    std::string_view value
 ) {
-    version.ReadConfig(ini, kSection);
-    author.ReadConfig(ini, kSection);
-    enableSkillCaps.ReadConfig(ini, kSection);
-    enableSkillFormulaCaps.ReadConfig(ini, kSection);
-    enableEnchantingPatch.ReadConfig(ini, kSection);
-    enableSkillExpMults.ReadConfig(ini, kSection);
-    enableLevelExpMults.ReadConfig(ini, kSection);
-    enablePerkPoints.ReadConfig(ini, kSection);
-    enableAttributePoints.ReadConfig(ini, kSection);
-    enableLegendary.ReadConfig(ini, kSection);
+    (void)slot;
+    return static_cast<T*>(setting)->ReadEntry(key, value);
 }
 
 /**
- * @brief Saves the general settings section.
+ * @brief Reads an INI entry into the leveled list or grid of the section's
+ *        skill.
  */
+template <typename T>
+bool
+Settings::ReadSkillSection(
+    void *setting,
+    SkillSlot::t slot,
+    std::string_view key,
+    std::string_view value
+) {
+    return static_cast<T*>(setting)->ReadEntry(slot, key, value);
+}
+
+/**
+ * @brief Adds the section of the given setting to the section table.
+ */
+template <typename T>
 void
-Settings::GeneralSettings::SaveConfig(
-    CSimpleIniA &ini
+Settings::AddSections(
+    T &setting
 ) {
-    version.SaveConfig(ini, kSection, kVersionDesc);
-    author.SaveConfig(ini, kSection, NULL);
-    enableSkillCaps.SaveConfig(ini, kSection, kEnableSkillCapsDesc);
-    enableSkillFormulaCaps.SaveConfig(ini, kSection, kEnableSkillFormulaCapsDesc);
-    enableEnchantingPatch.SaveConfig(ini, kSection, kEnableEnchantingPatchDesc);
-    enableSkillExpMults.SaveConfig(ini, kSection, kEnableSkillExpMultsDesc);
-    enableLevelExpMults.SaveConfig(ini, kSection, kEnableLevelExpMultsDesc);
-    enablePerkPoints.SaveConfig(ini, kSection, kEnablePerkPointsDesc);
-    enableAttributePoints.SaveConfig(ini, kSection, kEnableAttributePointsDesc);
-    enableLegendary.SaveConfig(ini, kSection, kEnableLegendaryDesc);
+    SectionTarget target = {};
+    target.read = ReadSection<T>;
+    target.setting = &setting;
+    sectionTable.Add(setting.Section(), target);
 }
 
 /**
- * @brief Reads in the enchant settings section.
+ * @brief Adds the section of each skill's leveled list or grid to the section
+ *        table.
  */
+template <template<typename> class L, typename T>
 void
-Settings::EnchantSettings::ReadConfig(
-    CSimpleIniA &ini
+Settings::AddSkillSections(
+    SkillSettingManager<L, T> &setting
 ) {
-    magnitudeLevelCap.ReadConfig(ini, kSection);
-    chargeLevelCap.ReadConfig(ini, kSection);
-    useLinearChargeFormula.ReadConfig(ini, kSection);
+    for (int i = 0; i < SkillSlot::kCount; i++) {
+        SectionTarget target = {};
+        target.read = ReadSkillSection<SkillSettingManager<L, T>>;
+        target.setting = &setting;
+        target.slot = static_cast<SkillSlot::t>(i);
+        sectionTable.Add(std::string(setting.Section()) + SkillSlot::Str(target.slot), target);
+    }
 }
 
 /**
- * @brief Saves the enchant settings section.
+ * @brief Adds the section of each skill's leveled list to the section table.
  */
+template <typename T>
 void
-Settings::EnchantSettings::SaveConfig(
-    CSimpleIniA &ini
+Settings::AddSections(
+    SkillSettingManager<LeveledSetting, T> &setting
 ) {
-    magnitudeLevelCap.SaveConfig(ini, kSection, kMagnitudeLevelCapDesc);
-    chargeLevelCap.SaveConfig(ini, kSection, kChargeLevelCapDesc);
-    useLinearChargeFormula.SaveConfig(ini, kSection, kUseLinearChargeFormulaDesc);
+    AddSkillSections(setting);
 }
 
 /**
- * @brief Reads in the legendary skill settings section.
+ * @brief Adds the section of each skill's grid to the section table.
  */
+template <typename T>
 void
-Settings::LegendarySettings::ReadConfig(
-    CSimpleIniA &ini
+Settings::AddSections(
+    SkillSettingManager<LeveledGrid, T> &setting
 ) {
-    keepSkillLevel.ReadConfig(ini, kSection);
-    hideButton.ReadConfig(ini, kSection);
-    skillLevelEnable.ReadConfig(ini, kSection);
-    skillLevelAfter.ReadConfig(ini, kSection);
+    AddSkillSections(setting);
 }
 
 /**
- * @brief Saves the legendary skill settings section.
+ * @brief Builds the table of every INI section the settings are read from.
+ *
+ * This only needs to be done once, as the section names never change.
  */
 void
-Settings::LegendarySettings::SaveConfig(
-    CSimpleIniA &ini
+Settings::BuildSectionTable() {
+    ForEachSetting([this](auto setting, const char *) {
+        AddSections(this->*setting);
+    });
+
+    sectionTable.Build();
+}
+
+/**
+ * @brief Finds the settings which the given INI section is read into.
+ *
+ * This is done once for each section header, rather than for every entry.
+ *
+ * @param sec The name of the section.
+ * @return The settings of the section, or Ignored if it isn't one of ours.
+ */
+Settings::SectionTarget
+Settings::FindSection(
+    std::string_view sec
 ) {
-    keepSkillLevel.SaveConfig(ini, kSection, kKeepSkillLevelDesc);
-    hideButton.SaveConfig(ini, kSection, kHideButtonDesc);
-    skillLevelEnable.SaveConfig(ini, kSection, kSkillLevelEnableDesc);
-    skillLevelAfter.SaveConfig(ini, kSection, kSkillLevelAfterDesc);
+    const SectionTarget *target = sectionTable.Find(sec);
+    if (target) {
+        return *target;
+    }
+
+    SectionTarget ignored = {};
+    return ignored;
 }
 
 /**
- * @brief Saves the given INI file to the given path.
- * @param ini The INI file to be saved.
- * @param path The path to save the file to.
+ * @brief Calls the given function on the leveled list of each skill.
+ */
+template <typename T, typename F>
+static void
+ForEachList(
+    SkillSettingManager<LeveledSetting, T> &setting,
+    F &f
+) {
+    for (int i = 0; i < SkillSlot::kCount; i++) {
+        SkillSlot::t slot = static_cast<SkillSlot::t>(i);
+        f(setting.Get(slot), slot);
+    }
+}
+
+/**
+ * @brief Calls the given function on the grid of each skill, as grids are
+ *        placed in the arena in the same way as the lists.
+ */
+template <typename T, typename F>
+static void
+ForEachList(
+    SkillSettingManager<LeveledGrid, T> &setting,
+    F &f
+) {
+    for (int i = 0; i < SkillSlot::kCount; i++) {
+        SkillSlot::t slot = static_cast<SkillSlot::t>(i);
+        f(setting.Get(slot), slot);
+    }
+}
+
+/**
+ * @brief Calls the given function on a leveled list which doesn't belong to a
+ *        skill, giving it kCount as its skill.
+ */
+template <typename T, typename F>
+static void
+ForEachList(
+    LeveledSetting<T> &setting,
+    F &f
+) {
+    f(setting, SkillSlot::kCount);
+}
+
+/**
+ * @brief Other settings have no leveled lists.
+ */
+template <typename T, typename F>
+static void
+ForEachList(
+    T &setting,
+    F &f
+) {
+    (void)setting;
+    (void)f;
+}
+
+/**
+ * @brief Calls the given function on every leveled list and grid, along with
+ *        the skill it belongs to.
+ */
+template <typename F>
+void
+Settings::ForEachLeveledList(
+    F &&f
+) {
+    ForEachSetting([&](auto setting, const char *) {
+        ForEachList(this->*setting, f);
+    });
+}
+
+/**
+ * @brief Points every leveled list and grid at its storage in the arena.
+ * @return True if every list and grid is valid.
  */
 bool
-Settings::SaveConfig(
-    CSimpleIniA &ini,
-    const std::string &path
+Settings::BindLeveledLists() {
+    bool ok = true;
+    ForEachLeveledList([&](auto &list, SkillSlot::t) {
+        ok = list.Bind(leveledArena) && ok;
+    });
+
+    return ok;
+}
+
+/**
+ * @brief Finishes reading in the configuration, and builds the lookup tables
+ *        which depend on it.
+ */
+void
+Settings::EndRead() {
+    ForEachSetting([this](auto setting, const char *) {
+        (this->*setting).EndRead();
+    });
+
+    // Every list and grid is compiled into one block. Those of each skill sit
+    // next to each other, as an exp event reads all of them.
+    size_t size = 0;
+    ForEachLeveledList([&](auto &list, SkillSlot::t) {
+        size += list.ArenaSize();
+    });
+    leveledArena.Reset(size);
+    for (int i = 0; i <= SkillSlot::kCount; i++) {
+        ForEachLeveledList([&](auto &list, SkillSlot::t slot) {
+            if (slot == i) {
+                list.Place(leveledArena);
+            }
+        });
+    }
+
+    bool bound = BindLeveledLists();
+    ASSERT(bound);
+
+    perkSchedule.Compile(perksAtLevelUp);
+
+    AttributeLevelUpTable::Sources level_up_sources = {
+        { &healthAtLevelUp, &magickaAtHealthLevelUp,
+          &staminaAtHealthLevelUp, &carryWeightAtHealthLevelUp },
+        { &healthAtMagickaLevelUp, &magickaAtLevelUp,
+          &staminaAtMagickaLevelUp, &carryWeightAtMagickaLevelUp },
+        { &healthAtStaminaLevelUp, &magickaAtStaminaLevelUp,
+          &staminaAtLevelUp, &carryWeightAtStaminaLevelUp }
+    };
+    attributeLevelUps.Compile(level_up_sources);
+}
+
+/**
+ * @brief Reads the settings from the given INI file contents.
+ *
+ * The contents are read in a single pass, with each entry going straight to
+ * the setting it belongs to. Settings which aren't in the file are left at
+ * their defaults.
+ *
+ * @param data The contents of the INI file.
+ * @param size The size of the contents.
+ */
+void
+Settings::ParseConfig(
+    const char *data,
+    size_t size
 ) {
-    _MESSAGE("Saving config file...");
+    if (sectionTable.IsEmpty()) {
+        BuildSectionTable();
+    }
 
-    // Clear the INI file; we will rewrite it.
-    ini.Reset();
+    BeginRead();
+
+    IniTokenizer tokens(data, size);
+    std::string_view sec, key, value;
+    std::string_view last_sec;
+    bool found = false;
+    SectionTarget target;
+    unsigned int unknown = 0;
+    while (tokens.Next(sec, key, value)) {
+        // Entries under the same header share a view, so we only need to
+        // look up the section when we reach a new one.
+        bool new_sec = !found || (sec.data() != last_sec.data())
+                    || (sec.size() != last_sec.size());
+        if (new_sec) {
+            target = FindSection(sec);
+            last_sec = sec;
+            found = true;
+        }
 
-    // Reset the general information.
-    general.version.Set(CONFIG_VERSION);
-    general.SaveConfig(ini);
-    skillCaps.SaveConfig(ini, kSkillCapsDesc);
-    skillFormulaCaps.SaveConfig(ini, kSkillFormulaCapsDesc);
-    enchant.SaveConfig(ini);
-    skillExpGainMults.SaveConfig(ini, kSkillExpGainMultsDesc);
-    skillExpGainMultsWithSkills.SaveConfig(ini, kSkillExpGainMultsWithSkillsDesc);
-    skillExpGainMultsWithPCLevel.SaveConfig(ini, kSkillExpGainMultsWithPCLevelDesc);
-    levelSkillExpMults.SaveConfig(ini, kLevelSkillExpMultsDesc);
-    levelSkillExpMultsWithSkills.SaveConfig(ini, kLevelSkillExpMultsWithSkillsDesc);
-    levelSkillExpMultsWithPCLevel.SaveConfig(ini, kLevelSkillExpMultsWithPCLevelDesc);
-    perksAtLevelUp.SaveConfig(ini, kPerksAtLevelUpDesc);
-    healthAtLevelUp.SaveConfig(ini, kHealthAtLevelUpDesc);
-    healthAtMagickaLevelUp.SaveConfig(ini, kHealthAtMagickaLevelUpDesc);
-    healthAtStaminaLevelUp.SaveConfig(ini, kHealthAtStaminaLevelUpDesc);
-    magickaAtLevelUp.SaveConfig(ini, kMagickaAtLevelUpDesc);
-    magickaAtHealthLevelUp.SaveConfig(ini, kMagickaAtHealthLevelUpDesc);
-    magickaAtStaminaLevelUp.SaveConfig(ini, kMagickaAtStaminaLevelUpDesc);
-    staminaAtLevelUp.SaveConfig(ini, kStaminaAtLevelUpDesc);
-    staminaAtHealthLevelUp.SaveConfig(ini, kStaminaAtHealthLevelUpDesc);
-    staminaAtMagickaLevelUp.SaveConfig(ini, kStaminaAtMagickaLevelUpDesc);
-    carryWeightAtHealthLevelUp.SaveConfig(ini, kCarryWeightAtHealthLevelUpDesc);
-    carryWeightAtMagickaLevelUp.SaveConfig(ini, kCarryWeightAtMagickaLevelUpDesc);
-    carryWeightAtStaminaLevelUp.SaveConfig(ini, kCarryWeightAtStaminaLevelUpDesc);
-    legendary.SaveConfig(ini);
-
-    // Save the generated INI file.
-    SI_Error er = ini.SaveFile(path.c_str());
-    if (er < SI_OK) {
-        _ERROR("Can't save config file ret:%d errno:%d", (int)er,  errno);
-        return false;
-    } else {
-        _MESSAGE("Config file saved.");
-        return true;
+        if (target.read && target.read(target.setting, target.slot, key, value)) {
+            continue;
+        }
+
+        // Only report each unknown section once, rather than every entry.
+        unknown++;
+        if (target.read) {
+            _WARNING(
+                "Unknown setting %.*s in section [%.*s].",
+                (int)key.size(), key.data(),
+                (int)sec.size(), sec.data()
+            );
+        } else if (new_sec) {
+            _WARNING("Unknown section [%.*s].", (int)sec.size(), sec.data());
+        }
     }
+
+    EndRead();
+    if (unknown) {
+        _WARNING("Ignored %u unknown entries in the config file.", unknown);
+    }
+}
+
+/**
+ * @brief Writes the compiled settings to the settings cache.
+ */
+void
+Settings::SaveCache(
+    CacheWriter &cache
+) {
+    leveledArena.SaveCache(cache);
+    ForEachSetting([&](auto setting, const char *) {
+        (this->*setting).SaveCache(cache);
+    });
+    perkSchedule.SaveCache(cache);
+    attributeLevelUps.SaveCache(cache);
+}
+
+/**
+ * @brief Reads the compiled settings from the settings cache.
+ *
+ * If this fails, the settings are left partially read, and must be read again
+ * from the INI file.
+ *
+ * @return True if every setting was read.
+ */
+bool
+Settings::LoadCache(
+    CacheReader &cache
+) {
+    bool ok = leveledArena.LoadCache(cache);
+    ForEachSetting([&](auto setting, const char *) {
+        ok = ok && (this->*setting).LoadCache(cache);
+    });
+
+    return ok && BindLeveledLists() && perkSchedule.LoadCache(cache)
+        && attributeLevelUps.LoadCache(cache);
 }
 
 /**
@@ -295,6 +436,10 @@ Settings::SaveConfig(
  * If the given file does not exist, the INI will be created with the default
  * settings at the specified location.
  *
+ * Once an INI file has been read, its compiled settings are cached in a file
+ * next to it. Later loads of the same file read the cache instead, unless it
+ * is missing, stale, or corrupt.
+ *
  * @param path The path to read the INI file from.
  */
 bool
@@ -303,19 +448,34 @@ Settings::ReadConfig(
 ) {
     // Attempt to load the INI file.
     _MESSAGE("Loading config file %s...", path.c_str());
-    CSimpleIniA ini;
-    SI_Error er = ini.LoadFile(path.c_str());
-    bool need_save = false;
-    if (er < SI_OK) {
-        if ((er != SI_FILE) || (errno != ENOENT)) {
-            _ERROR("Can't load config file ret:%d errno:%d", (int)er,  errno);
-            return false;
-        }
-        need_save = true; // No such file or directory.
+    MappedFile file;
+    MappedFile::Status status = file.Open(path.c_str());
+    if (status == MappedFile::Failed) {
+        _ERROR("Can't load config file %s", path.c_str());
+        return false;
+    }
+    bool need_save = (status == MappedFile::NotFound);
+
+    // The compiled settings are cached next to the INI, and only used if
+    // they were built from exactly this file.
+    std::string cache_path = path + ".cache";
+    ConfigCacheKey key = {
+        file.Size(),
+        file.Modified(),
+        HashConfigData(file.Data(), file.Size()),
+        CONFIG_VERSION,
+        CONFIG_CACHE_VERSION
+    };
+
+    bool parsed = false;
+    CacheReader cached;
+    if (!need_save && cached.Open(cache_path, key) && LoadCache(cached) && cached.AtEnd()) {
+        _MESSAGE("Loaded compiled config from %s.", cache_path.c_str());
+    } else {
+        ParseConfig(file.Data(), file.Size());
+        parsed = true;
     }
 
-    // Load general info.
-    general.ReadConfig(ini);
     _MESSAGE("INI version: %d", general.version.Get());
 
     // Check if we need to write out the configuration.
@@ -326,37 +486,70 @@ Settings::ReadConfig(
         need_save = true;
     }
 
-    skillCaps.ReadConfig(ini);
-    skillFormulaCaps.ReadConfig(ini);
-    enchant.ReadConfig(ini);
-    skillExpGainMults.ReadConfig(ini);
-    skillExpGainMultsWithSkills.ReadConfig(ini);
-    skillExpGainMultsWithPCLevel.ReadConfig(ini);
-    levelSkillExpMults.ReadConfig(ini);
-    levelSkillExpMultsWithSkills.ReadConfig(ini);
-    levelSkillExpMultsWithPCLevel.ReadConfig(ini);
-    perksAtLevelUp.ReadConfig(ini);
-    healthAtLevelUp.ReadConfig(ini);
-    healthAtMagickaLevelUp.ReadConfig(ini);
-    healthAtStaminaLevelUp.ReadConfig(ini);
-    magickaAtLevelUp.ReadConfig(ini);
-    magickaAtHealthLevelUp.ReadConfig(ini);
-    magickaAtStaminaLevelUp.ReadConfig(ini);
-    staminaAtLevelUp.ReadConfig(ini);
-    staminaAtHealthLevelUp.ReadConfig(ini);
-    staminaAtMagickaLevelUp.ReadConfig(ini);
-    carryWeightAtHealthLevelUp.ReadConfig(ini);
-    carryWeightAtMagickaLevelUp.ReadConfig(ini);
-    carryWeightAtStaminaLevelUp.ReadConfig(ini);
-    legendary.ReadConfig(ini);
-
     _MESSAGE("Done!");
 
     // Save the configuration, if necessary.
     if (need_save) {
-        return SaveConfig(ini, path);
-    } else {
-        return true;
+        return SaveConfig(path, file);
+    }
+
+    if (parsed) {
+        CacheWriter cache;
+        SaveCache(cache);
+        if (!cache.Save(cache_path, key)) {
+            _MESSAGE("Could not write config cache %s.", cache_path.c_str());
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Copies the fields of a section which choose the installed patches.
+ * @return True if any of the fields changed.
+ */
+template <typename Fields>
+static bool
+KeepPatches(
+    SettingsSection<Fields> &to,
+    SettingsSection<Fields> &from
+) {
+    return to.KeepPatchesFrom(from);
+}
+
+/**
+ * @brief Settings other than named values never choose the installed patches.
+ */
+template <typename T>
+static bool
+KeepPatches(
+    T &to,
+    T &from
+) {
+    (void)to;
+    (void)from;
+    return false;
+}
+
+/**
+ * @brief Copies which patches are enabled from the given settings.
+ *
+ * Patches are only installed at startup, so settings which are reloaded
+ * later must keep the same patches enabled.
+ *
+ * @param from The settings the patches were installed with.
+ */
+void
+Settings::KeepPatchesFrom(
+    Settings &from
+) {
+    bool changed = false;
+    ForEachSetting([&](auto setting, const char *) {
+        changed |= KeepPatches(this->*setting, from.*setting);
+    });
+
+    if (changed) {
+        _WARNING("Enabling or disabling patches requires restarting the game.");
     }
 }
 
@@ -417,9 +610,13 @@ Settings::GetSkillExpGainMult(
 ) {
     SkillSlot::t slot = SkillSlot::FromAttribute(skill);
     float base_mult = skillExpGainMults.Get(slot).Get();
-    float skill_mult = skillExpGainMultsWithSkills.Get(slot).GetNearest(skill_level);
-    float pc_mult = skillExpGainMultsWithPCLevel.Get(slot).GetNearest(player_level);
-    return base_mult * skill_mult * pc_mult;
+    float skill_mult = skillExpGainMultsWithSkills.Get(slot).Get(skill_level);
+    float pc_mult = skillExpGainMultsWithPCLevel.Get(slot).Get(player_level);
+    float mult = base_mult * skill_mult * pc_mult;
+
+    // Most skills have no grid, which is 1.0 everywhere.
+    LeveledGrid<float> &grid = skillExpGainMultsGrid.Get(slot);
+    return grid.Empty() ? mult : (mult * grid.Get(skill_level, player_level));
 }
 
 /**
@@ -437,9 +634,12 @@ Settings::GetLevelSkillExpMult(
 ) {
     SkillSlot::t slot = SkillSlot::FromAttribute(skill);
     float base_mult = levelSkillExpMults.Get(slot).Get();
-    float skill_mult = levelSkillExpMultsWithSkills.Get(slot).GetNearest(skill_level);
-    float pc_mult = levelSkillExpMultsWithPCLevel.Get(slot).GetNearest(player_level);
-    return base_mult * skill_mult * pc_mult;
+    float skill_mult = levelSkillExpMultsWithSkills.Get(slot).Get(skill_level);
+    float pc_mult = levelSkillExpMultsWithPCLevel.Get(slot).Get(player_level);
+    float mult = base_mult * skill_mult * pc_mult;
+
+    LeveledGrid<float> &grid = levelSkillExpMultsGrid.Get(slot);
+    return grid.Empty() ? mult : (mult * grid.Get(skill_level, player_level));
 }
 
 /**
@@ -450,7 +650,7 @@ unsigned int
 Settings::GetPerkDelta(
     unsigned int player_level
 ) {
-    return perksAtLevelUp.GetCumulativeDelta(player_level);
+    return perkSchedule.GetDelta(player_level);
 }
 
 /**
@@ -466,36 +666,7 @@ Settings::GetAttributeLevelUp(
     ActorAttribute::t choice,
     ActorAttributeLevelUp &level_up
 ) {
-    unsigned int health = 0, magicka = 0, stamina = 0, carry_weight = 0;
-    switch (choice) {
-        case ActorAttribute::Health:
-            health = healthAtLevelUp.GetNearest(player_level);
-            magicka = magickaAtHealthLevelUp.GetNearest(player_level);
-            stamina = staminaAtHealthLevelUp.GetNearest(player_level);
-            carry_weight = carryWeightAtHealthLevelUp.GetNearest(player_level);
-            break;
-        case ActorAttribute::Magicka:
-            health = healthAtMagickaLevelUp.GetNearest(player_level);
-            magicka = magickaAtLevelUp.GetNearest(player_level);
-            stamina = staminaAtMagickaLevelUp.GetNearest(player_level);
-            carry_weight = carryWeightAtMagickaLevelUp.GetNearest(player_level);
-            break;
-        case ActorAttribute::Stamina:
-            health = healthAtStaminaLevelUp.GetNearest(player_level);
-            magicka = magickaAtStaminaLevelUp.GetNearest(player_level);
-            stamina = staminaAtLevelUp.GetNearest(player_level);
-            carry_weight = carryWeightAtStaminaLevelUp.GetNearest(player_level);
-            break;
-        default:
-            HALT("Cannot get attribute level up with an invalid choice.");
-    }
-
-    level_up = {
-        static_cast<float>(health),
-        static_cast<float>(magicka),
-        static_cast<float>(stamina),
-        static_cast<float>(carry_weight)
-    };
+    level_up = attributeLevelUps.Get(player_level, choice);
 }
 
 /**
@@ -13,14 +13,39 @@
 #define __SKYRIM_UNCAPPER_AE_SETTINGS_H__
 
 #include <string>
+#include <string_view>
 #include <vector>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <limits>
+#include <charconv>
+#include <type_traits>
+#include <emmintrin.h>
 
 #include "Compare.h"
+#include "ConfigCache.h"
+#include "MappedFile.h"
+#include "LeveledArena.h"
+#include "LeveledGrid.h"
+#include "Interpolation.h"
+#include "Formula.h"
 #include "SkillSlot.h"
 #include "Ini.h"
+#include "NameTable.h"
 #include "ActorAttribute.h"
+#include "PerkSchedule.h"
+#include "AttributeLevelUpTable.h"
+#include "SettingsSchema.h"
 
-#define CONFIG_VERSION 6
+#define CONFIG_VERSION 8
+
+/// @brief Bump whenever the layout of the compiled settings cache changes.
+#define CONFIG_CACHE_VERSION 11
+
+/// @brief The highest level the player can reach, as the game keeps it in 16
+///        bits.
+#define MAX_PLAYER_LEVEL 65535
 
 template<typename T>
 class LeveledSetting {
@@ -33,103 +58,353 @@ class LeveledSetting {
     /// @brief The buffer size used to concat the section and subsection.
     static const size_t kBufSize = 256;
 
-    std::vector<LevelItem> list;
+    /// @brief Lists this long or shorter are searched with SIMD compares.
+    static const size_t kSmallListSize = 16;
+
+    /// @brief The number of levels compared at once by the small search.
+    static const size_t kLanes = 4;
+
+    /// @brief Interpolated lists store the value of each level below this.
+    static const size_t kMaxTableLevels = 4096;
+
+    /// @brief The key which sets the interpolation mode of a list.
+    static constexpr const char *kInterpolationKey = "Interpolation";
+
+    /// @brief The key which gives the list as a formula of the level.
+    static constexpr const char *kFormulaKey = "Formula";
+
+    /**
+     * @brief The entries read from the INI file.
+     *
+     * Once compiled, these are the sorted entries of the list, until they are
+     * placed in the arena.
+     */
+    std::vector<LevelItem> pending;
+
+    /**
+     * @brief The compiled levels in the arena, in ascending order, starting
+     *        at 0.
+     *
+     * Padded with UINT_MAX to a multiple of kLanes, so that the small search
+     * can always read whole vectors.
+     */
+    const uint32_t *levels;
+
+    /// @brief The value of each level in the arena, just after the levels.
+    const uint32_t *items;
+
+    /**
+     * @brief The interpolated value of every level from 0, in the arena just
+     *        after the items. Only interpolated lists have one.
+     */
+    const uint32_t *table;
+
+    /// @brief The offset of the list in the arena, in words.
+    uint32_t offset;
+
+    /// @brief The number of levels with a value. Does not count the padding.
+    uint32_t count;
+
+    /// @brief The number of levels in the interpolated table.
+    uint32_t tableSize;
+
+    /// @brief How the list blends between the levels which have a value.
+    Interpolation::t mode;
+
+    /// @brief Whether the mode was given in the INI file.
+    bool modeRead;
+
+    /// @brief The formula of the list, as written in the INI file, if any.
+    std::string formulaText;
+
+    /// @brief The parsed formula, which is only kept until the list is placed.
+    Formula formula;
+
     const char *section;
     T defaultVal;
 
     /**
-     * @brief Adds an item to the leveled setting list.
+     * @brief Sorts the entries which were read in, and fills in level 0.
      *
-     * If the given item is already in the setting list, it will not be added
-     * again.
-     *
-     * @param level The level for the item.
-     * @param item The item to be added.
+     * If a level appears more than once, the first entry is kept. If level 0
+     * does not appear, it is given the default value. A list with a formula
+     * is given its first and last table levels instead.
      */
     void
-    Add(
-        unsigned int level,
-        T item
-    ) {
-        // Store the items in sorted order, so we can binary search for the
-        // nearest later.
-        size_t lo = 0, hi = list.size();
-        size_t mid = lo + ((hi - lo) >> 1);
-        while (lo < hi) {
-            ASSERT(mid < list.size());
-            if (level < list[mid].level) {
-                hi = mid;
-            } else if (level > list[mid].level) {
-                lo = mid + 1;
-            } else {
-                return;
+    Compile() {
+        // A formula gives the value of every level in the table, which is
+        // followed by the value of its last level.
+        if (!formula.Empty()) {
+            if (!pending.empty()) {
+                _WARNING("Levels given with the formula %s are ignored.", formulaText.c_str());
             }
 
-            mid = lo + ((hi - lo) >> 1);
+            pending.clear();
+            pending.push_back({ 0, FromReal(formula.Eval(0)) });
+            pending.push_back({ kMaxTableLevels - 1, FromReal(formula.Eval(kMaxTableLevels - 1)) });
+            tableSize = kMaxTableLevels;
+            return;
         }
 
-        // Insert before the final hi element.
-        ASSERT(hi <= list.size());
-        list.insert(list.begin() + hi, { level, item });
+        // A stable sort keeps repeated levels in file order, so unique()
+        // keeps the first of each.
+        std::stable_sort(pending.begin(), pending.end(), [](const LevelItem &a, const LevelItem &b) {
+            return a.level < b.level;
+        });
+        auto last = std::unique(pending.begin(), pending.end(), [](const LevelItem &a, const LevelItem &b) {
+            return a.level == b.level;
+        });
+        pending.erase(last, pending.end());
+
+        if (pending.empty() || (pending[0].level != 0)) {
+            pending.insert(pending.begin(), { 0, defaultVal });
+        }
+
+        // A list with a single level has nothing to blend.
+        tableSize = ((mode == Interpolation::Step) || (pending.size() < 2))
+            ? 0
+            : static_cast<uint32_t>(MIN(kMaxTableLevels, static_cast<size_t>(pending.back().level) + 1));
     }
 
     /**
-     * @brief Reads in the configuration from the given INI file.
-     * @param ini The INI to read the config from.
-     * @param sec The section to read in the INI.
-     * @param val The default value if none is found.
+     * @brief Gets the level and value of the i'th compiled entry.
+     *
+     * The entries are read from the pending list while it is being placed,
+     * and from the arena once the list has been bound.
      */
-    void
-    InternalReadConfig(
-        CSimpleIniA &ini,
-        const char *sec,
-        T val
+    inline LevelItem
+    EntryAt(
+        size_t i
     ) {
-        CSimpleIniA::TNamesDepend keys;
+        return pending.empty() ? LevelItem{ levels[i], ItemAt(i) } : pending[i];
+    }
 
-        list.clear();
-        if (ini.GetAllKeys(sec, keys)) {
-            for (auto& element : keys) {\
-                Add(
-                    atoi(element.pItem),
-                    ReadIniValue(ini, sec, element.pItem, val)
-                );
-            }
+    /**
+     * @brief Gets the slope between the i'th compiled entry and the next.
+     */
+    double
+    Secant(
+        size_t i
+    ) {
+        LevelItem a = EntryAt(i), b = EntryAt(i + 1);
+        return (static_cast<double>(b.item) - static_cast<double>(a.item))
+             / static_cast<double>(b.level - a.level);
+    }
+
+    /**
+     * @brief Gets the slope of the cubic curve at the i'th compiled entry.
+     *
+     * This is the weighted harmonic mean of the slopes on either side
+     * (Fritsch-Butland), which keeps the curve monotone between entries. The
+     * curve is flat at any entry which is a peak or a valley.
+     */
+    double
+    Tangent(
+        size_t i
+    ) {
+        if (i == 0) {
+            return Secant(0);
+        } else if ((i + 1) == count) {
+            return Secant(i - 1);
+        }
+
+        double d0 = Secant(i - 1);
+        double d1 = Secant(i);
+        if ((d0 * d1) <= 0) {
+            return 0;
+        }
+
+        double h0 = EntryAt(i).level - EntryAt(i - 1).level;
+        double h1 = EntryAt(i + 1).level - EntryAt(i).level;
+        double w0 = 2 * h1 + h0;
+        double w1 = h1 + 2 * h0;
+        return (w0 + w1) / (w0 / d0 + w1 / d1);
+    }
+
+    /**
+     * @brief Finds the value of a level between two compiled entries.
+     * @param i The entry at or below the level. Must not be the last entry.
+     * @param level The level to find the value of.
+     */
+    T
+    Interpolate(
+        size_t i,
+        unsigned int level
+    ) {
+        LevelItem a = EntryAt(i), b = EntryAt(i + 1);
+        double y0 = a.item;
+        double y1 = b.item;
+        double h = b.level - a.level;
+        double t = (level - a.level) / h;
+
+        double val;
+        if (mode == Interpolation::Linear) {
+            val = y0 + t * (y1 - y0);
+        } else {
+            // Cubic Hermite basis, which passes through both entries with the
+            // given slopes.
+            double t2 = t * t;
+            double t3 = t2 * t;
+            val = (2 * t3 - 3 * t2 + 1) * y0 + (t3 - 2 * t2 + t) * h * Tangent(i)
+                + (3 * t2 - 2 * t3) * y1 + (t3 - t2) * h * Tangent(i + 1);
+        }
+
+        return FromReal(val);
+    }
+
+    /**
+     * @brief Converts a computed value to a value of the list.
+     *
+     * Whole number settings are rounded, and clamped to the range of their
+     * type. Values which aren't finite use the default instead.
+     */
+    T
+    FromReal(
+        double val
+    ) {
+        if (!std::isfinite(val)) {
+            return defaultVal;
         }
 
-        Add(0, val);
-        list.shrink_to_fit();
+        if constexpr (std::is_integral<T>::value) {
+            val = MAX(val, static_cast<double>(std::numeric_limits<T>::lowest()));
+            val = MIN(val, static_cast<double>(std::numeric_limits<T>::max()));
+            return static_cast<T>(std::floor(val + 0.5));
+        } else {
+            T ret = static_cast<T>(val);
+            return std::isfinite(ret) ? ret : defaultVal;
+        }
+    }
+
+    /**
+     * @brief Converts a word of the arena to a value of the list.
+     */
+    static inline T
+    FromWord(
+        uint32_t word
+    ) {
+        T val;
+        memcpy(&val, &word, sizeof(val));
+        return val;
+    }
+
+    /**
+     * @brief Gets the number of levels in a list of the given size, once
+     *        padded to a multiple of kLanes.
+     */
+    static inline size_t
+    PaddedSize(
+        size_t size
+    ) {
+        return ((size + kLanes - 1) / kLanes) * kLanes;
+    }
+
+    /**
+     * @brief Finds the index of the last level at or below the given level,
+     *        by counting the levels above it with SIMD compares.
+     */
+    size_t
+    FindSmall(
+        unsigned int level
+    ) {
+        // SSE2 only has signed compares, so flip the sign bits to compare
+        // unsigned values.
+        const __m128i bias = _mm_set1_epi32(INT_MIN);
+        __m128i key = _mm_xor_si128(_mm_set1_epi32(static_cast<int>(level)), bias);
+
+        // Each lane of a compare is -1 where the level is above the key.
+        size_t padded = PaddedSize(count);
+        __m128i above = _mm_setzero_si128();
+        for (size_t i = 0; i < padded; i += kLanes) {
+            __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&levels[i]));
+            above = _mm_sub_epi32(above, _mm_cmpgt_epi32(_mm_xor_si128(l, bias), key));
+        }
+        above = _mm_add_epi32(above, _mm_shuffle_epi32(above, _MM_SHUFFLE(1, 0, 3, 2)));
+        above = _mm_add_epi32(above, _mm_shuffle_epi32(above, _MM_SHUFFLE(2, 3, 0, 1)));
+
+        size_t at_or_below = padded - static_cast<size_t>(_mm_cvtsi128_si32(above));
+        return MIN(at_or_below, static_cast<size_t>(count)) - 1;
+    }
+
+    /**
+     * @brief Finds the index of the last level at or below the given level,
+     *        with a branch-free binary search.
+     */
+    size_t
+    FindLarge(
+        unsigned int level
+    ) {
+        const uint32_t *base = levels;
+        size_t n = count;
+        while (n > 1) {
+            size_t half = n >> 1;
+            base = (base[half] <= level) ? (base + half) : base;
+            n -= half;
+        }
+
+        return base - levels;
     }
 
     /**
      * @brief Saves the content of the list to the given INI file.
+     *
+     * A list which the file being updated already has is left as it is.
+     *
      * @param ini The INI file to write to.
      * @param sec The section to write to.
      * @param comment The comment to write to the first element.
      */
     void
     InternalSaveConfig(
-        CSimpleIniA &ini,
+        IniWriter &ini,
         const char *sec,
         const char *comment
     ) {
+        if (ini.HasSection(sec)) {
+            return;
+        }
+
+        // The levels of a formula list are generated, so only the formula is
+        // written out.
+        if (!formulaText.empty()) {
+            SaveIniValue(ini, sec, kFormulaKey, formulaText, comment);
+            return;
+        }
+
+        // Step is the default, so it isn't written out.
+        if (mode != Interpolation::Step) {
+            SaveIniValue(ini, sec, kInterpolationKey, std::string(Interpolation::Str(mode)), comment);
+            comment = NULL;
+        }
+
         char key[16];
-        for (size_t i = 0; i < list.size(); i++) {
-            ASSERT(sprintf_s(key, "%d", list[i].level) > 0);\
+        for (size_t i = 0; i < Size(); i++) {
+            auto res = std::to_chars(key, key + sizeof(key), static_cast<int>(LevelAt(i)));
+            ASSERT(res.ec == std::errc());
             SaveIniValue(
                 ini,
                 sec,
-                key,
-                list[i].item,
+                std::string_view(key, res.ptr - key),
+                ItemAt(i),
                 (!i) ? (comment) : NULL
             );
         }
     }
 
   public:
-    /// @brief Default constructor. Must give args to ReadConfig()/SaveConfig().
+    /// @brief Default constructor. Must give args to BeginRead()/SaveConfig().
     LeveledSetting(
-    ) : list(0),
+    ) : pending(0),
+        levels(nullptr),
+        items(nullptr),
+        table(nullptr),
+        offset(0),
+        count(0),
+        tableSize(0),
+        mode(Interpolation::Step),
+        modeRead(false),
+        formulaText(),
+        formula(),
         section(nullptr),
         defaultVal(0)
     {}
@@ -137,7 +412,7 @@ class LeveledSetting {
     /**
      * @brief Constructs a leveled setting with the given section and default.
      *
-     * If this initializer is used, then it is illegal to call ReadConfig()
+     * If this initializer is used, then it is illegal to call BeginRead()
      * and SaveConfig() with more than the ini argument.
      *
      * @param section The section to read/write the setting to.
@@ -146,51 +421,224 @@ class LeveledSetting {
     LeveledSetting(
         const char *section,
         T default_val
-    ) : list(0),
+    ) : pending(0),
+        levels(nullptr),
+        items(nullptr),
+        table(nullptr),
+        offset(0),
+        count(0),
+        tableSize(0),
+        mode(Interpolation::Step),
+        modeRead(false),
+        formulaText(),
+        formula(),
         section(section),
         defaultVal(default_val)
     {}
 
     /**
-     * @brief Reads in the configuration from the given INI file.
+     * @brief Clears the list, so that a new configuration can be read in.
      *
      * It is illegal to call this function if the list was initialized with
      * the non-default constructor.
      *
-     * @param ini The ini file to read the configuration from.
-     * @param sec The section to read the configuration from.
-     * @param subsec The subsection to read the config from.
-     * @param val A default value if no config is found.
+     * @param val The default value for levels with no entry.
      */
     void
-    ReadConfig(
-        CSimpleIniA &ini,
-        const char *sec,
-        const char *subsec,
+    BeginRead(
         T val
     ) {
         ASSERT(section == nullptr);
+        defaultVal = val;
+        mode = Interpolation::Step;
+        modeRead = false;
+        formulaText.clear();
+        formula.Clear();
+        pending.clear();
+    }
 
-        char buf[kBufSize];
-        auto res = sprintf_s(buf, "%s%s", sec, subsec);
-        ASSERT((0 < res) && (res < kBufSize));
-        InternalReadConfig(ini, buf, val);
+    /**
+     * @brief Clears the list, so that a new configuration can be read in.
+     *
+     * It is illegal to call this function if the list was initialized with
+     * the default constructor.
+     */
+    void
+    BeginRead() {
+        ASSERT(section);
+        mode = Interpolation::Step;
+        modeRead = false;
+        formulaText.clear();
+        formula.Clear();
+        pending.clear();
     }
 
     /**
-     * @brief Reads in the configuration from the given INI file.
+     * @brief Gets the INI section which holds this list.
      *
      * It is illegal to call this function if the list was initialized with
-     * the default constuctor.
+     * the default constructor.
+     */
+    inline const char *
+    Section() {
+        ASSERT(section);
+        return section;
+    }
+
+    /**
+     * @brief Adds an entry read from the INI file to the list.
+     *
+     * Entries are only gathered here, and sorted once the whole file has been
+     * read. If a level, the mode or the formula appears more than once, the
+     * first entry is kept.
      *
-     * @param ini The ini file to read the configuration from.
+     * @param key The key of the entry, which is the level, or the key which
+     *            sets the interpolation mode or formula.
+     * @param value The value of the entry.
+     * @return True, as every key in a list is a level, the mode or the formula.
+     */
+    bool
+    ReadEntry(
+        std::string_view key,
+        std::string_view value
+    ) {
+        if (IniNameEquals(key, kInterpolationKey)) {
+            if (modeRead) {
+                return true;
+            } else if (Interpolation::FromName(value, mode)) {
+                modeRead = true;
+            } else {
+                _WARNING("Unknown interpolation mode %.*s.", (int)value.size(), value.data());
+            }
+            return true;
+        }
+
+        if (IniNameEquals(key, kFormulaKey)) {
+            size_t error;
+            if (!formula.Empty()) {
+                return true;
+            } else if (formula.Parse(value, error)) {
+                formulaText = value;
+            } else {
+                _WARNING(
+                    "Invalid formula %.*s, at column %zu.",
+                    (int)value.size(),
+                    value.data(),
+                    error + 1
+                );
+            }
+            return true;
+        }
+
+        pending.push_back({ ParseIniLevel(key), ParseIniValue(value, defaultVal) });
+        return true;
+    }
+
+    /**
+     * @brief Finishes reading in the list, filling in the default for level 0.
+     *
+     * The list can't be used until it has been placed in an arena and bound
+     * to it.
+     */
+    void
+    EndRead() {
+        Compile();
+    }
+
+    /**
+     * @brief Gets the number of words the compiled list takes in an arena.
+     */
+    inline size_t
+    ArenaSize() {
+        return PaddedSize(pending.size()) + pending.size() + tableSize;
+    }
+
+    /**
+     * @brief Appends the compiled list to the given arena.
+     *
+     * The levels are written first, padded to a multiple of kLanes, followed
+     * by their values. An interpolated list then has the value of every level
+     * up to its last entry, so that a lookup never has to blend. A formula list
+     * has the value of every level in its table instead, so that the formula
+     * is never evaluated at runtime.
      */
     void
-    ReadConfig(
-        CSimpleIniA &ini
+    Place(
+        LeveledArena &arena
     ) {
-        ASSERT(section);
-        InternalReadConfig(ini, section, defaultVal);
+        offset = static_cast<uint32_t>(arena.Size());
+        count = static_cast<uint32_t>(pending.size());
+
+        for (auto &entry : pending) {
+            arena.Push(entry.level);
+        }
+        for (size_t i = count; i < PaddedSize(count); i++) {
+            arena.Push(UINT_MAX);
+        }
+        for (auto &entry : pending) {
+            arena.Push(entry.item);
+        }
+
+        if (!formula.Empty()) {
+            bool invalid = false;
+            for (uint32_t level = 0; level < tableSize; level++) {
+                double val = formula.Eval(level);
+                invalid = invalid || !std::isfinite(val);
+                arena.Push(FromReal(val));
+            }
+
+            if (invalid) {
+                _WARNING("The formula %s has no value at some levels, so the default is used.", formulaText.c_str());
+            }
+        } else {
+            size_t i = 0;
+            for (uint32_t level = 0; level < tableSize; level++) {
+                while (((i + 1) < count) && (pending[i + 1].level <= level)) {
+                    i++;
+                }
+
+                arena.Push(((i + 1) < count) ? Interpolate(i, level) : pending[i].item);
+            }
+        }
+
+        std::vector<LevelItem>().swap(pending);
+        formula.Clear();
+    }
+
+    /**
+     * @brief Points the list at its storage in the given arena.
+     *
+     * The storage is checked, as it may have been read from the cache.
+     *
+     * @return True if the list is valid.
+     */
+    bool
+    Bind(
+        const LeveledArena &arena
+    ) {
+        levels = items = table = nullptr;
+
+        size_t padded = PaddedSize(count);
+        if (!count || (mode >= Interpolation::kCount) || (tableSize > kMaxTableLevels)
+                || ((mode == Interpolation::Step) && formulaText.empty() && tableSize)
+                || (offset > arena.Size()) || (arena.Size() - offset < padded + count + tableSize)) {
+            return false;
+        }
+
+        const uint32_t *l = arena.Data() + offset;
+        if (l[0] != 0) {
+            return false;
+        }
+        for (size_t i = 1; i < padded; i++) {
+            if ((i < count) ? (l[i - 1] >= l[i]) : (l[i] != UINT_MAX)) {
+                return false;
+            }
+        }
+
+        levels = l;
+        items = l + padded;
+        table = tableSize ? (items + count) : nullptr;
+        return true;
     }
 
     /**
@@ -206,7 +654,7 @@ class LeveledSetting {
      */
     void
     SaveConfig(
-        CSimpleIniA &ini,
+        IniWriter &ini,
         const char *sec,
         const char *subsec,
         const char *comment
@@ -215,7 +663,7 @@ class LeveledSetting {
 
         char buf[kBufSize];
         auto res = sprintf_s(buf, "%s%s", sec, subsec);
-        ASSERT((0 < res) && (res < kBufSize));
+        ASSERT((0 < res) && (static_cast<size_t>(res) < kBufSize));
         InternalSaveConfig(ini, buf, comment);
     }
 
@@ -230,7 +678,7 @@ class LeveledSetting {
      */
     void
     SaveConfig(
-        CSimpleIniA &ini,
+        IniWriter &ini,
         const char *comment
     ) {
         ASSERT(section);
@@ -238,71 +686,104 @@ class LeveledSetting {
     }
 
     /**
-     * @brief Finds the value closest to the given level in the list.
+     * @brief Writes where the compiled list is in the arena, how it is
+     *        interpolated, and its formula, to the settings cache.
      *
-     * Note that only values whose level is less than or equal to the given
-     * level will be considered.
+     * The arena itself is cached separately.
+     */
+    void
+    SaveCache(
+        CacheWriter &cache
+    ) {
+        cache.Write(offset);
+        cache.Write(count);
+        cache.Write(tableSize);
+        cache.Write(static_cast<uint32_t>(mode));
+        cache.Write(formulaText);
+    }
+
+    /**
+     * @brief Reads where the compiled list is in the arena from the settings
+     *        cache. The list must then be bound to the arena.
+     * @return True if the location was read.
+     */
+    bool
+    LoadCache(
+        CacheReader &cache
+    ) {
+        uint32_t m;
+        if (!cache.Read(offset) || !cache.Read(count) || !cache.Read(tableSize) || !cache.Read(m)
+                || !cache.Read(formulaText)) {
+            return false;
+        }
+
+        mode = static_cast<Interpolation::t>(m);
+        return true;
+    }
+
+    /**
+     * @brief Gets the value of the given level in the list.
      *
-     * @param level The level to search for an item for.
+     * A step list uses the value of the closest level at or below the given
+     * level. An interpolated or formula list reads the value from its table.
+     * Past its table, an interpolated list blends the entries on either side
+     * of the level as the table would have, and a formula list keeps the
+     * value of its last table level.
+     *
+     * @param level The level to get the value of.
      * @return The associated value.
      */
     T
-    GetNearest(
+    Get(
         unsigned int level
     ) {
-        ASSERT(list.size() > 0);
-
-        size_t lo = 0, hi = list.size();
-        size_t mid = lo + ((hi - lo) >> 1);
-        while (lo < hi) {
-            ASSERT(mid < list.size());
-            if ((list[mid].level <= level)
-                    && ((mid + 1 == list.size()) || (level < list[mid + 1].level))) {
-                return list[mid].item;
-            } else if (level < list[mid].level) {
-                hi = mid;
-            } else {
-                ASSERT((level > list[mid].level) || (level >= list[mid + 1].level));
-                lo = mid + 1;
-            }
+        ASSERT(levels && (levels[0] == 0));
+        if (level < tableSize) {
+            return FromWord(table[level]);
+        }
 
-            mid = lo + ((hi - lo) >> 1);
+        size_t i = (count <= kSmallListSize) ? FindSmall(level) : FindLarge(level);
+        if (tableSize && ((i + 1) < count)) {
+            return Interpolate(i, level);
         }
 
-        // If no direct match was found, return the closest lo item.
-        return list[lo].item;
+        return ItemAt(i);
     }
 
     /**
-     * @brief Accumulates the values across all previous levels, and determines
-     *        what the increment from the last level was.
+     * @brief Gets the level from which the list only changes at its entries.
      *
-     * This function is intended to be used for the calculation of partial
-     * perk point awards.
-     *
-     * @param level The new level of the player.
-     * @return The increment from the previous level.
+     * Below this level, an interpolated or formula list may have a different
+     * value at every level.
      */
-    unsigned int
-    GetCumulativeDelta(
-        unsigned int level
-    ) {
-        ASSERT(list.size() > 0);
+    inline unsigned int
+    BlendEnd() {
+        ASSERT(levels);
+        return tableSize ? MAX(tableSize, levels[count - 1]) : 0;
+    }
 
-        T pacc = 0, acc = 0;
-        for (size_t i = 0; (i < list.size()) && (list[i].level <= level); i++) {
-            // Update the accumulation. Note the exclusive upper bound on level.
-            unsigned int bound = ((i + 1) < list.size()) ? list[i + 1].level : level + 1;
-            unsigned int this_level = MIN(level + 1, bound);
-            acc += (this_level - list[i].level) * list[i].item;
+    /// @brief Gets the number of levels with an explicit value.
+    inline size_t
+    Size() {
+        return count;
+    }
 
-            // If this is the last iteration, get the previous accumulation.
-            if (((i + 1) >= list.size()) || (list[i + 1].level > level)) {
-                pacc = acc - list[i].item;
-            }
-        }
+    /// @brief Gets the level of the i'th entry, in ascending order.
+    inline unsigned int
+    LevelAt(
+        size_t i
+    ) {
+        ASSERT(levels && (i < count));
+        return levels[i];
+    }
 
-        return static_cast<unsigned int>(acc) - static_cast<unsigned int>(pacc);
+    /// @brief Gets the value of the i'th entry, in ascending level order.
+    inline T
+    ItemAt(
+        size_t i
+    ) {
+        ASSERT(items && (i < count));
+        return FromWord(items[i]);
     }
 };
 
@@ -326,25 +807,38 @@ class SkillSetting {
     }
 
     /**
-     * @brief Reads in the config from the given ini file.
-     * @param ini The INI to read from.
-     * @param section The section to read from.
-     * @param field The field to read from.
+     * @brief Resets the value, so that a new configuration can be read in.
      * @param default_val The value to assume if the data is not available.
      */
-    void
-    ReadConfig(
-        CSimpleIniA &ini,
-        const char *section,
-        const char *field,
+    inline void
+    BeginRead(
         T default_val
     ) {
-        char buf[kBufSize];
-        auto res = sprintf_s(buf, "%c%s", GetPrefix<T>(), field);
-        ASSERT((0 < res) && (res < kBufSize));
-        val = ReadIniValue(ini, section, buf, default_val);
+        val = default_val;
+    }
+
+    /**
+     * @brief Reads in the value of an INI entry for this setting.
+     * @param value The value of the entry.
+     * @param default_val The value to assume if the entry can't be parsed.
+     */
+    inline void
+    ReadValue(
+        std::string_view value,
+        T default_val
+    ) {
+        val = ParseIniValue(value, default_val);
     }
 
+    /// @brief Finishes reading. A single value needs no further work.
+    inline void EndRead(void) {}
+
+    /// @brief Writes the value to the settings cache.
+    inline void SaveCache(CacheWriter &cache) { cache.Write(val); }
+
+    /// @brief Reads the value from the settings cache.
+    inline bool LoadCache(CacheReader &cache) { return cache.Read(val); }
+
     /**
      * @brief Saves the current value to the given INI file.
      * @param ini The INI to save to.
@@ -354,14 +848,14 @@ class SkillSetting {
      */
     void
     SaveConfig(
-        CSimpleIniA &ini,
+        IniWriter &ini,
         const char *section,
         const char *field,
         const char *comment
     ) {
         char buf[kBufSize];
         auto res = sprintf_s(buf, "%c%s", GetPrefix<T>(), field);
-        ASSERT((0 < res) && (res < kBufSize));
+        ASSERT((0 < res) && (static_cast<size_t>(res) < kBufSize));
         SaveIniValue(ini, section, buf, val, comment);
     }
 };
@@ -393,17 +887,101 @@ class SkillSettingManager {
     }
 
     /**
-     * @brief Reads in the given configuration file.
-     * @param ini The ini file to read.
+     * @brief Resets every skill, so that a new configuration can be read in.
+     */
+    void
+    BeginRead() {
+        for (int i = 0; i < SkillSlot::kCount; i++) {
+            data[i].BeginRead(defaultVal);
+        }
+    }
+
+    /**
+     * @brief Finishes reading in the configuration of every skill.
      */
     void
-    ReadConfig(
-        CSimpleIniA &ini
+    EndRead() {
+        for (int i = 0; i < SkillSlot::kCount; i++) {
+            data[i].EndRead();
+        }
+    }
+
+    /**
+     * @brief Gets the INI section of this manager.
+     *
+     * When each skill has a leveled list or grid, this is the prefix of the
+     * section of each skill, which is followed by the skill name.
+     */
+    inline const char *
+    Section() {
+        return section;
+    }
+
+    /**
+     * @brief Reads in an INI entry from the section of this manager.
+     *
+     * Only used when each skill has a single value.
+     *
+     * @param key The key of the entry.
+     * @param value The value of the entry.
+     * @return True if the key was a type prefixed skill name.
+     */
+    bool
+    ReadEntry(
+        std::string_view key,
+        std::string_view value
+    ) {
+        SkillSlot::t slot;
+        if (key.empty() || (key[0] != GetPrefix<U>())
+                || !SkillSlot::FromName(key.substr(1), slot)) {
+            return false;
+        }
+
+        data[slot].ReadValue(value, defaultVal);
+        return true;
+    }
+
+    /**
+     * @brief Reads in an INI entry for the leveled list or grid of the given
+     *        skill.
+     * @return True if the entry was read into the list or grid.
+     */
+    bool
+    ReadEntry(
+        SkillSlot::t slot,
+        std::string_view key,
+        std::string_view value
+    ) {
+        return data[slot].ReadEntry(key, value);
+    }
+
+    /**
+     * @brief Writes the setting of every skill to the settings cache.
+     */
+    void
+    SaveCache(
+        CacheWriter &cache
     ) {
         for (int i = 0; i < SkillSlot::kCount; i++) {
-            SkillSlot::t slot = static_cast<SkillSlot::t>(i);
-            data[i].ReadConfig(ini, section, SkillSlot::Str(slot), defaultVal);
+            data[i].SaveCache(cache);
+        }
+    }
+
+    /**
+     * @brief Reads the setting of every skill from the settings cache.
+     * @return True if every skill was read.
+     */
+    bool
+    LoadCache(
+        CacheReader &cache
+    ) {
+        for (int i = 0; i < SkillSlot::kCount; i++) {
+            if (!data[i].LoadCache(cache)) {
+                return false;
+            }
         }
+
+        return true;
     }
 
     /**
@@ -413,7 +991,7 @@ class SkillSettingManager {
      */
     void
     SaveConfig(
-        CSimpleIniA &ini,
+        IniWriter &ini,
         const char *comment
     ) {
         for (int i = 0; i < SkillSlot::kCount; i++) {
@@ -423,180 +1001,266 @@ class SkillSettingManager {
     }
 };
 
+/**
+ * @brief A section of named values, whose fields are declared by a table in
+ *        SettingsSchema.h.
+ *
+ * The fields are members of the base class, which lists them for ForEach() as
+ * pointers to members. This gives a section of named values the same interface
+ * as every other kind of setting.
+ */
+template <typename Fields>
+class SettingsSection : public Fields {
+  private:
+    const char *section;
+
+  public:
+    explicit SettingsSection(
+        const char *section
+    ) : section(section)
+    {}
+
+    /// @brief Gets the INI section of this setting.
+    inline const char *Section(void) { return section; }
+
+    /**
+     * @brief Resets every field to its default, so that a new configuration
+     *        can be read in.
+     */
+    void
+    BeginRead() {
+        Fields::ForEach([this](auto field, const char *, bool) {
+            (this->*field).Reset();
+        });
+    }
+
+    /// @brief Finishes reading. Named values need no further work.
+    inline void EndRead(void) {}
+
+    /**
+     * @brief Reads in an INI entry from this section.
+     * @param key The key of the entry.
+     * @param value The value of the entry.
+     * @return True if the key was one of our fields.
+     */
+    bool
+    ReadEntry(
+        std::string_view key,
+        std::string_view value
+    ) {
+        bool found = false;
+        Fields::ForEach([&](auto field, const char *, bool) {
+            found = found || (this->*field).ReadEntry(key, value);
+        });
+
+        return found;
+    }
+
+    /**
+     * @brief Writes every field to the settings cache.
+     */
+    void
+    SaveCache(
+        CacheWriter &cache
+    ) {
+        Fields::ForEach([&](auto field, const char *, bool) {
+            cache.Write((this->*field).Get());
+        });
+    }
+
+    /**
+     * @brief Reads every field from the settings cache.
+     * @return True if every field was read.
+     */
+    bool
+    LoadCache(
+        CacheReader &cache
+    ) {
+        bool ok = true;
+        Fields::ForEach([&](auto field, const char *, bool) {
+            auto val = (this->*field).Get();
+            ok = ok && cache.Read(val);
+            if (ok) {
+                (this->*field).Set(val);
+            }
+        });
+
+        return ok;
+    }
+
+    /**
+     * @brief Writes out every field to the given INI file.
+     * @param ini The ini file to write the fields to.
+     * @param comment Unused, as each field has its own comment.
+     */
+    void
+    SaveConfig(
+        IniWriter &ini,
+        const char *comment
+    ) {
+        (void)comment;
+        Fields::ForEach([&](auto field, const char *field_comment, bool) {
+            (this->*field).SaveConfig(ini, section, field_comment);
+        });
+    }
+
+    /**
+     * @brief Copies the fields which choose the installed patches.
+     * @param from The section to copy the fields from.
+     * @return True if any of the fields changed.
+     */
+    bool
+    KeepPatchesFrom(
+        SettingsSection &from
+    ) {
+        bool changed = false;
+        Fields::ForEach([&](auto field, const char *, bool patch) {
+            if (patch) {
+                auto val = (from.*field).Get();
+                changed |= ((this->*field).Get() != val);
+                (this->*field).Set(val);
+            }
+        });
+
+        return changed;
+    }
+};
+
+/// @brief Skips a setting in a schema expansion.
+#define SETTINGS_SCHEMA_SKIP(...)
+
+/// @brief Declares a field of a section of named values.
+#define SETTINGS_FIELD_MEMBER(type, member, key, default_val, patch, comment)\
+    SectionField<type> member{ key, static_cast<type>(default_val) };
+
+/// @brief Lists the key of a field, so duplicates can be caught.
+#define SETTINGS_FIELD_KEY(type, member, key, default_val, patch, comment) key,
+
+/// @brief Passes a field to the function given to ForEach().
+#define SETTINGS_FIELD_VISIT(type, member, key, default_val, patch, comment)\
+    f(&Self::member, comment, patch);
+
+/**
+ * @brief Declares the struct which holds the fields of a section of named
+ *        values, and checks that no two fields share a key.
+ */
+#define SETTINGS_DECLARE_FIELDS(fields, member, section, FIELDS)\
+    struct fields {\
+        typedef fields Self;\
+        FIELDS(SETTINGS_FIELD_MEMBER)\
+        static constexpr const char *kKeys[] = { FIELDS(SETTINGS_FIELD_KEY) };\
+        template <typename F> static void ForEach(F &&f) { FIELDS(SETTINGS_FIELD_VISIT) }\
+    };\
+    static_assert(IniNamesUnique(fields::kKeys), "Duplicate key in section [" section "].");
+
+SETTINGS_SCHEMA(
+    SETTINGS_DECLARE_FIELDS,
+    SETTINGS_SCHEMA_SKIP,
+    SETTINGS_SCHEMA_SKIP,
+    SETTINGS_SCHEMA_SKIP,
+    SETTINGS_SCHEMA_SKIP
+)
+
+/// @brief Declares a section of named values.
+#define SETTINGS_DECLARE_SECTION(fields, member, section, FIELDS)\
+    SettingsSection<fields> member{ section };
+
+/// @brief Declares a section with a value for each skill.
+#define SETTINGS_DECLARE_SKILL(type, member, section, default_val, comment)\
+    SkillSettingManager<SkillSetting, type> member{ section, static_cast<type>(default_val) };
+
+/// @brief Declares a leveled list for each skill.
+#define SETTINGS_DECLARE_SKILL_LEVELED(type, member, section, default_val, comment)\
+    SkillSettingManager<LeveledSetting, type> member{ section, static_cast<type>(default_val) };
+
+/// @brief Declares a grid keyed by skill level and player level for each skill.
+#define SETTINGS_DECLARE_SKILL_GRID(type, member, section, default_val, comment)\
+    SkillSettingManager<LeveledGrid, type> member{ section, static_cast<type>(default_val) };
+
+/// @brief Declares a leveled list.
+#define SETTINGS_DECLARE_LEVELED(type, member, section, default_val, comment)\
+    LeveledSetting<type> member{ section, static_cast<type>(default_val) };
+
+/// @brief Passes a section of named values to the function given to ForEachSetting().
+#define SETTINGS_VISIT_SECTION(fields, member, section, FIELDS)\
+    f(&Settings::member, NULL);
+
+/// @brief Passes any other setting to the function given to ForEachSetting().
+#define SETTINGS_VISIT_SETTING(type, member, section, default_val, comment)\
+    f(&Settings::member, comment);
+
 class Settings {
   private:
-    class GeneralSettings {
-      private:
-        static const char *const kSection;
-        static const char *const kVersionDesc;
-        static const char *const kEnableSkillCapsDesc;
-        static const char *const kEnableSkillFormulaCapsDesc;
-        static const char *const kEnableEnchantingPatchDesc;
-        static const char *const kEnableSkillExpMultsDesc;
-        static const char *const kEnableLevelExpMultsDesc;
-        static const char *const kEnablePerkPointsDesc;
-        static const char *const kEnableAttributePointsDesc;
-        static const char *const kEnableLegendaryDesc;
-
-      public:
-        SectionField<unsigned int> version;
-        SectionField<std::string> author;
-        SectionField<bool> enableSkillCaps;
-        SectionField<bool> enableSkillFormulaCaps;
-        SectionField<bool> enableEnchantingPatch;
-        SectionField<bool> enableSkillExpMults;
-        SectionField<bool> enableLevelExpMults;
-        SectionField<bool> enablePerkPoints;
-        SectionField<bool> enableAttributePoints;
-        SectionField<bool> enableLegendary;
-
-        GeneralSettings(
-        ) : version("Version", 0),
-            author("Author", "Kassent"),
-            enableSkillCaps("bUseSkillCaps", true),
-            enableSkillFormulaCaps("bUseSkillFormulaCaps", true),
-            enableEnchantingPatch("bUseEnchanterCaps", true),
-            enableSkillExpMults("bUseSkillExpGainMults", true),
-            enableLevelExpMults("bUsePCLevelSkillExpMults", true),
-            enablePerkPoints("bUsePerksAtLevelUp", true),
-            enableAttributePoints("bUseAttributesAtLevelUp", true),
-            enableLegendary("bUseLegendarySettings", true)
-        {}
-
-        void ReadConfig(CSimpleIniA &ini);
-        void SaveConfig(CSimpleIniA &ini);
+    /// @brief The settings which an INI section is read into.
+    struct SectionTarget {
+        /// @brief Reads an entry into the setting. NULL if the section isn't ours.
+        bool (*read)(void *setting, SkillSlot::t slot, std::string_view key,
+                     std::string_view value);
+        void *setting;
+        SkillSlot::t slot;
     };
 
-    class EnchantSettings {
-      private:
-        static const char *const kSection;
-        static const char *const kMagnitudeLevelCapDesc;
-        static const char *const kChargeLevelCapDesc;
-        static const char *const kUseLinearChargeFormulaDesc;
-
-      public:
-        SectionField<unsigned int> magnitudeLevelCap;
-        SectionField<unsigned int> chargeLevelCap;
-        SectionField<bool> useLinearChargeFormula;
-
-        EnchantSettings(
-        ) : magnitudeLevelCap("iMagnitudeLevelCap", 100),
-            chargeLevelCap("iChargeLevelCap", 199),
-            useLinearChargeFormula("bUseLinearChargeFormula", false)
-        {}
-
-        void ReadConfig(CSimpleIniA &ini);
-        void SaveConfig(CSimpleIniA &ini);
-    };
+    /// @brief Maps each INI section name to the settings it is read into.
+    NameTable<SectionTarget> sectionTable;
 
-    class LegendarySettings {
-      private:
-        static const char *const kSection;
-        static const char *const kKeepSkillLevelDesc;
-        static const char *const kHideButtonDesc;
-        static const char *const kSkillLevelEnableDesc;
-        static const char *const kSkillLevelAfterDesc;
-
-      public:
-        SectionField<bool> keepSkillLevel;
-        SectionField<bool> hideButton;
-        SectionField<unsigned int> skillLevelEnable;
-        SectionField<unsigned int> skillLevelAfter;
-
-        LegendarySettings(
-        ) : keepSkillLevel("bLegendaryKeepSkillLevel", false),
-            hideButton("bHideLegendaryButton", true),
-            skillLevelEnable("iSkillLevelEnableLegendary", 100),
-            skillLevelAfter("iSkillLevelAfterLegendary", 0)
-        {}
-
-        void ReadConfig(CSimpleIniA &ini);
-        void SaveConfig(CSimpleIniA &ini);
-    };
+    /**
+     * @brief Calls the given function on every setting in the schema, in the
+     *        order they are saved.
+     * @param f Called with a pointer to the member of each setting, and the
+     *          comment to save with it.
+     */
+    template <typename F>
+    static void
+    ForEachSetting(
+        F &&f
+    ) {
+        SETTINGS_SCHEMA(
+            SETTINGS_VISIT_SECTION,
+            SETTINGS_VISIT_SETTING,
+            SETTINGS_VISIT_SETTING,
+            SETTINGS_VISIT_SETTING,
+            SETTINGS_VISIT_SETTING
+        )
+    }
 
-    static const char *const kSkillCapsDesc;
-    static const char *const kSkillFormulaCapsDesc;
-    static const char *const kSkillExpGainMultsDesc;
-    static const char *const kSkillExpGainMultsWithPCLevelDesc;
-    static const char *const kSkillExpGainMultsWithSkillsDesc;
-    static const char *const kLevelSkillExpMultsDesc;
-    static const char *const kLevelSkillExpMultsWithPCLevelDesc;
-    static const char *const kLevelSkillExpMultsWithSkillsDesc;
-    static const char *const kPerksAtLevelUpDesc;
-    static const char *const kHealthAtLevelUpDesc;
-    static const char *const kHealthAtMagickaLevelUpDesc;
-    static const char *const kHealthAtStaminaLevelUpDesc;
-    static const char *const kMagickaAtLevelUpDesc;
-    static const char *const kMagickaAtHealthLevelUpDesc;
-    static const char *const kMagickaAtStaminaLevelUpDesc;
-    static const char *const kStaminaAtLevelUpDesc;
-    static const char *const kStaminaAtHealthLevelUpDesc;
-    static const char *const kStaminaAtMagickaLevelUpDesc;
-    static const char *const kCarryWeightAtHealthLevelUpDesc;
-    static const char *const kCarryWeightAtMagickaLevelUpDesc;
-    static const char *const kCarryWeightAtStaminaLevelUpDesc;
-
-    bool SaveConfig(CSimpleIniA &ini, const std::string &path);
-
-    GeneralSettings general;
-
-    SkillSettingManager<SkillSetting, unsigned int> skillCaps;
-    SkillSettingManager<SkillSetting, unsigned int> skillFormulaCaps;
-
-    EnchantSettings enchant;
-
-    SkillSettingManager<SkillSetting, float> skillExpGainMults;
-    SkillSettingManager<LeveledSetting, float> skillExpGainMultsWithSkills;
-    SkillSettingManager<LeveledSetting, float> skillExpGainMultsWithPCLevel;
-
-    SkillSettingManager<SkillSetting, float> levelSkillExpMults;
-    SkillSettingManager<LeveledSetting, float> levelSkillExpMultsWithSkills;
-    SkillSettingManager<LeveledSetting, float> levelSkillExpMultsWithPCLevel;
-
-    LeveledSetting<float> perksAtLevelUp;
-    LeveledSetting<unsigned int> healthAtLevelUp;
-    LeveledSetting<unsigned int> healthAtMagickaLevelUp;
-    LeveledSetting<unsigned int> healthAtStaminaLevelUp;
-    LeveledSetting<unsigned int> magickaAtLevelUp;
-    LeveledSetting<unsigned int> magickaAtHealthLevelUp;
-    LeveledSetting<unsigned int> magickaAtStaminaLevelUp;
-    LeveledSetting<unsigned int> staminaAtLevelUp;
-    LeveledSetting<unsigned int> staminaAtHealthLevelUp;
-    LeveledSetting<unsigned int> staminaAtMagickaLevelUp;
-    LeveledSetting<unsigned int> carryWeightAtHealthLevelUp;
-    LeveledSetting<unsigned int> carryWeightAtMagickaLevelUp;
-    LeveledSetting<unsigned int> carryWeightAtStaminaLevelUp;
-
-    LegendarySettings legendary;
+    template <typename T>
+    static bool ReadSection(void *setting, SkillSlot::t slot, std::string_view key,
+                            std::string_view value);
+    template <typename T>
+    static bool ReadSkillSection(void *setting, SkillSlot::t slot, std::string_view key,
+                                 std::string_view value);
+    template <template<typename> class L, typename T>
+    void AddSkillSections(SkillSettingManager<L, T> &setting);
+    template <typename T> void AddSections(T &setting);
+    template <typename T> void AddSections(SkillSettingManager<LeveledSetting, T> &setting);
+    template <typename T> void AddSections(SkillSettingManager<LeveledGrid, T> &setting);
+    template <typename F> void ForEachLeveledList(F &&f);
+    bool BindLeveledLists(void);
+
+    void BuildSectionTable(void);
+    void BeginRead(void);
+    SectionTarget FindSection(std::string_view sec);
+    void EndRead(void);
+    void ParseConfig(const char *data, size_t size);
+    void SaveCache(CacheWriter &cache);
+    bool LoadCache(CacheReader &cache);
+    bool SaveConfig(const std::string &path, MappedFile &file);
+
+    SETTINGS_SCHEMA(
+        SETTINGS_DECLARE_SECTION,
+        SETTINGS_DECLARE_SKILL,
+        SETTINGS_DECLARE_SKILL_LEVELED,
+        SETTINGS_DECLARE_SKILL_GRID,
+        SETTINGS_DECLARE_LEVELED
+    )
+
+    /// @brief Holds the compiled storage of every leveled list.
+    LeveledArena leveledArena;
+
+    PerkSchedule perkSchedule;
+    AttributeLevelUpTable attributeLevelUps;
 
   public:
-    Settings(
-    ) : general(),
-        skillCaps("SkillCaps", 100),
-        skillFormulaCaps("SkillFormulaCaps", 100),
-        enchant(),
-        skillExpGainMults("SkillExpGainMults", 1.00),
-        skillExpGainMultsWithPCLevel("SkillExpGainMults\\CharacterLevel\\", 1.00),
-        skillExpGainMultsWithSkills("SkillExpGainMults\\BaseSkillLevel\\", 1.00),
-        levelSkillExpMults("LevelSkillExpMults", 1.00),
-        levelSkillExpMultsWithPCLevel("LevelSkillExpMults\\CharacterLevel\\", 1.00),
-        levelSkillExpMultsWithSkills("LevelSkillExpMults\\BaseSkillLevel\\", 1.00),
-        perksAtLevelUp("PerksAtLevelUp", 1.00),
-        healthAtLevelUp("HealthAtLevelUp", 10),
-        healthAtMagickaLevelUp("HealthAtMagickaLevelUp", 0),
-        healthAtStaminaLevelUp("HealthAtStaminaLevelUp", 0),
-        magickaAtLevelUp("MagickaAtLevelUp", 10),
-        magickaAtHealthLevelUp("MagickaAtHealthLevelUp", 0),
-        magickaAtStaminaLevelUp("MagickaAtStaminaLevelUp", 0),
-        staminaAtLevelUp("StaminaAtLevelUp", 10),
-        staminaAtHealthLevelUp("StaminaAtHealthLevelUp", 0),
-        staminaAtMagickaLevelUp("StaminaAtMagickaLevelUp", 0),
-        carryWeightAtHealthLevelUp("CarryWeightAtHealthLevelUp", 0),
-        carryWeightAtMagickaLevelUp("CarryWeightAtMagickaLevelUp", 0),
-        carryWeightAtStaminaLevelUp("CarryWeightAtStaminaLevelUp", 5),
-        legendary()
-    {}
-
     bool ReadConfig(const std::string& path);
 
     inline bool IsSkillCapEnabled(void) { return general.enableSkillCaps.Get(); }
@@ -607,6 +1271,9 @@ class Settings {
     inline bool IsPerkPointsEnabled(void) { return general.enablePerkPoints.Get(); }
     inline bool IsAttributePointsEnabled(void) { return general.enableAttributePoints.Get(); }
     inline bool IsLegendaryEnabled(void) { return general.enableLegendary.Get(); }
+    inline bool IsHotReloadEnabled(void) { return general.enableHotReload.Get(); }
+    inline bool IsHookTraceEnabled(void) { return general.enableHookTrace.Get(); }
+    void KeepPatchesFrom(Settings &from);
 
     float GetSkillCap(ActorAttribute::t skill);
     float GetSkillFormulaCap(ActorAttribute::t skill);
@@ -0,0 +1,197 @@
+/**
+ * @file SettingsSchema.h
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Declares every setting in the INI file, in the order it is saved.
+ * @bug No known bugs.
+ *
+ * The tables in this file are X-macros, which Settings.h and Settings.cpp
+ * expand to declare, read, cache and save the settings. A setting only needs
+ * to be added here; nothing else lists them.
+ */
+
+#ifndef __SKYRIM_UNCAPPER_AE_SETTINGS_SCHEMA_H__
+#define __SKYRIM_UNCAPPER_AE_SETTINGS_SCHEMA_H__
+
+// Comment on each leveled setting description.
+#define LEVELED_SETTING_NOTE\
+    "# If a specific level is not specified, then the\n"\
+    "# value for the closest lower level is used. Set Interpolation to\n"\
+    "# Linear or Cubic to blend between the levels instead, or set Formula\n"\
+    "# to an expression of level, such as 1.0 / (1 + 0.02 * level)."
+
+// Comment on the leveled settings which have a grid below them.
+#define GRID_SETTING_NOTE\
+    "# The Grid subsections below set an additional multiplier for each\n"\
+    "# pair of BASE SKILL LEVEL and CHARACTER LEVEL, written as\n"\
+    "# skill,level = value. Pairs which are not listed use 1.0, and each\n"\
+    "# level uses the closest lower listed levels. Set Interpolation to\n"\
+    "# Linear to blend between them instead."
+
+/*
+ * The fields of each section of named values. Each field is declared as:
+ *
+ * FIELD(type, member, key, default, patch, comment)
+ *
+ * Fields with patch set choose which patches are installed, and so keep their
+ * startup value when the settings are reloaded.
+ */
+
+#define GENERAL_FIELDS(FIELD)\
+    FIELD(unsigned int, version, "Version", 0, false,\
+        "# Do not manually change this field. Doing so can prevent this INI file\n"\
+        "# from updating with new versions.")\
+    FIELD(std::string, author, "Author", "Kassent", false, NULL)\
+    FIELD(bool, enableSkillCaps, "bUseSkillCaps", true, true,\
+        "# Enables the code which uncap skill levels.")\
+    FIELD(bool, enableSkillFormulaCaps, "bUseSkillFormulaCaps", true, true,\
+        "# Enables the code which cap all skill formulas.")\
+    FIELD(bool, enableEnchantingPatch, "bUseEnchanterCaps", true, true,\
+        "# Enables the code which patches to the enchantment charge cost "\
+        "calculation.")\
+    FIELD(bool, enableSkillExpMults, "bUseSkillExpGainMults", true, true,\
+        "# Enables the code which applies the skill experience multipliers.")\
+    FIELD(bool, enableLevelExpMults, "bUsePCLevelSkillExpMults", true, true,\
+        "# Enables the code which applies the level experience multipliers.")\
+    FIELD(bool, enablePerkPoints, "bUsePerksAtLevelUp", true, true,\
+        "# Enables the code which modifies perk point gain.")\
+    FIELD(bool, enableAttributePoints, "bUseAttributesAtLevelUp", true, true,\
+        "# Enables the code which modifies attribute point gain.")\
+    FIELD(bool, enableLegendary, "bUseLegendarySettings", true, true,\
+        "# Enables the code which modifies the legendary skill system.")\
+    FIELD(bool, enableHotReload, "bEnableHotReload", false, true,\
+        "# Reloads this file whenever it is saved while the game is running.\n"\
+        "# Changes to the bUse* settings above still require a restart.")\
+    FIELD(bool, enableHookTrace, "bEnableHookTrace", false, true,\
+        "# Records every call to the patched game code to SkyrimUncapper.trace,\n"\
+        "# next to this file, so the session can be replayed offline. The trace\n"\
+        "# is replaced each time the game starts.")
+
+#define ENCHANT_FIELDS(FIELD)\
+    FIELD(unsigned int, magnitudeLevelCap, "iMagnitudeLevelCap", 100, false,\
+        "# Sets the formula cap for the enchanting magnitude calculation.\n"\
+        "# This value is also capped by the enchanting skill formula cap.")\
+    FIELD(unsigned int, chargeLevelCap, "iChargeLevelCap", 199, false,\
+        "# Sets the formula cap for the enchanting weapon charge calculation.\n"\
+        "# The formula breaks above level 199, so values above that will be ignored.\n"\
+        "# This value is also capped by the enchanting skill formula cap.")\
+    FIELD(bool, useLinearChargeFormula, "bUseLinearChargeFormula", false, false,\
+        "# Forces the game to use a linear formula for level-based weapon\n"\
+        "# charge calculation. Useful if the charge cap is close to 199, as the\n"\
+        "# later level-ups in enchanting will give massive boosts to the number\n"\
+        "# of charge points available.")
+
+#define LEGENDARY_FIELDS(FIELD)\
+    FIELD(bool, keepSkillLevel, "bLegendaryKeepSkillLevel", false, false,\
+        "# This option determines whether the legendary feature will reset the\n"\
+        "# skill level. Setting this option to true will make the option\n"\
+        "# \"iSkillLevelAfterLegendary\" have no effect.")\
+    FIELD(bool, hideButton, "bHideLegendaryButton", true, false,\
+        "# This option determines whether to hide the legendary button in \"Skills\"\n"\
+        "# menu when you meet the requirements to legendary a skill.\n"\
+        "# If you set \"iSkillLevelEnableLegendary\" to below 100, the legendary\n"\
+        "# button will not show up, but you can make skills legendary normally\n"\
+        "# by pressing SPACE.")\
+    FIELD(unsigned int, skillLevelEnable, "iSkillLevelEnableLegendary", 100, false,\
+        "# This option determines the skill level required to make a skill legendary.")\
+    FIELD(unsigned int, skillLevelAfter, "iSkillLevelAfterLegendary", 0, false,\
+        "# This option determines the level of a skill after making it legendary.\n"\
+        "# Setting this option to 0 will reset the skill level to default level.")
+
+/*
+ * Every setting, in the order it is saved. Each kind of setting is declared as:
+ *
+ * SECTION(fields, member, section, FIELDS)
+ *     A section of named values, whose fields are listed by FIELDS.
+ * SKILL(type, member, section, default, comment)
+ *     A section with one value for each skill, keyed by the prefixed skill name.
+ * SKILL_LEVELED(type, member, section, default, comment)
+ *     A leveled list for each skill, in the section named by the given prefix
+ *     followed by the skill name.
+ * SKILL_GRID(type, member, section, default, comment)
+ *     A grid keyed by skill level and player level for each skill, in the
+ *     section named by the given prefix followed by the skill name.
+ * LEVELED(type, member, section, default, comment)
+ *     A leveled list in its own section.
+ */
+#define SETTINGS_SCHEMA(SECTION, SKILL, SKILL_LEVELED, SKILL_GRID, LEVELED)\
+    SECTION(GeneralFields, general, "General", GENERAL_FIELDS)\
+    SKILL(unsigned int, skillCaps, "SkillCaps", 100,\
+        "# Set the skill level cap. This option determines the upper limit of\n"\
+        "# skill level you can reach.")\
+    SKILL(unsigned int, skillFormulaCaps, "SkillFormulaCaps", 100,\
+        "# Set the skill formula cap. This option determines the upper limit of\n"\
+        "# skill level used in the calculation of all kinds of magic effects.")\
+    SECTION(EnchantFields, enchant, "Enchanting", ENCHANT_FIELDS)\
+    SKILL(float, skillExpGainMults, "SkillExpGainMults", 1.00,\
+        "# Set the skill experience gained multiplier. The skill experience\n"\
+        "# you gained actually = The final calculated experience value right\n"\
+        "# before it is given to the character after any experience\n"\
+        "# modification * SkillExpGainMult * Corresponding\n"\
+        "# Sub-SkillExpGainMult listed below.")\
+    SKILL_LEVELED(float, skillExpGainMultsWithSkills, "SkillExpGainMults\\BaseSkillLevel\\", 1.00,\
+        "# All the subsections of SkillExpGainMults below allow to set an\n"\
+        "# additional multiplier depending on BASE SKILL LEVEL, independantly\n"\
+        "# for each skill.")\
+    SKILL_LEVELED(float, skillExpGainMultsWithPCLevel, "SkillExpGainMults\\CharacterLevel\\", 1.00,\
+        "# All the subsections of SkillExpGainMults below allow to set an\n"\
+        "# additional multiplier depending on CHARACTER LEVEL, independantly\n"\
+        "# for each skill.\n"\
+        GRID_SETTING_NOTE)\
+    SKILL_GRID(float, skillExpGainMultsGrid, "SkillExpGainMults\\Grid\\", 1.00, NULL)\
+    SKILL(float, levelSkillExpMults, "LevelSkillExpMults", 1.00,\
+        "# Set the skill experience to PC experience multipliers. When you\n"\
+        "# level up a skill, the PC experience you gained actually = Current\n"\
+        "# base skill level * LevelSkillExpMults * Corresponding "\
+        "# Sub-LevelSkillExpMults listed below.")\
+    SKILL_LEVELED(float, levelSkillExpMultsWithSkills, "LevelSkillExpMults\\BaseSkillLevel\\", 1.00,\
+        "# All the subsections of LevelSkillExpMults below allow to set an\n"\
+        "# additional multipliers depending on BASE SKILL LEVEL, independantly\n"\
+        "# for each skill.")\
+    SKILL_LEVELED(float, levelSkillExpMultsWithPCLevel, "LevelSkillExpMults\\CharacterLevel\\", 1.00,\
+        "# All the subsections of LevelSkillExpMults below allow to set an\n"\
+        "# additional multipliers depending on CHARACTER LEVEL, independantly\n"\
+        "# for each skill.\n"\
+        GRID_SETTING_NOTE)\
+    SKILL_GRID(float, levelSkillExpMultsGrid, "LevelSkillExpMults\\Grid\\", 1.00, NULL)\
+    LEVELED(float, perksAtLevelUp, "PerksAtLevelUp", 1.00,\
+        "# Set the number of perks gained at each level up.\n"\
+        LEVELED_SETTING_NOTE)\
+    LEVELED(unsigned int, healthAtLevelUp, "HealthAtLevelUp", 10,\
+        "# Set the number of health gained at each health level up.\n"\
+        LEVELED_SETTING_NOTE)\
+    LEVELED(unsigned int, healthAtMagickaLevelUp, "HealthAtMagickaLevelUp", 0,\
+        "# Set the number of health gained at each magicka level up.\n"\
+        LEVELED_SETTING_NOTE)\
+    LEVELED(unsigned int, healthAtStaminaLevelUp, "HealthAtStaminaLevelUp", 0,\
+        "# Set the number of health gained at each stamina level up.\n"\
+        LEVELED_SETTING_NOTE)\
+    LEVELED(unsigned int, magickaAtLevelUp, "MagickaAtLevelUp", 10,\
+        "# Set the number of magicka gained at each magicka level up.\n"\
+        LEVELED_SETTING_NOTE)\
+    LEVELED(unsigned int, magickaAtHealthLevelUp, "MagickaAtHealthLevelUp", 0,\
+        "# Set the number of magicka gained at each health level up.\n"\
+        LEVELED_SETTING_NOTE)\
+    LEVELED(unsigned int, magickaAtStaminaLevelUp, "MagickaAtStaminaLevelUp", 0,\
+        "# Set the number of magicka gained at each stamina level up.\n"\
+        LEVELED_SETTING_NOTE)\
+    LEVELED(unsigned int, staminaAtLevelUp, "StaminaAtLevelUp", 10,\
+        "# Set the number of stamina gained at each stamina level up.\n"\
+        LEVELED_SETTING_NOTE)\
+    LEVELED(unsigned int, staminaAtHealthLevelUp, "StaminaAtHealthLevelUp", 0,\
+        "# Set the number of stamina gained at each health level up.\n"\
+        LEVELED_SETTING_NOTE)\
+    LEVELED(unsigned int, staminaAtMagickaLevelUp, "StaminaAtMagickaLevelUp", 0,\
+        "# Set the number of stamina gained at each magicka level up.\n"\
+        LEVELED_SETTING_NOTE)\
+    LEVELED(unsigned int, carryWeightAtHealthLevelUp, "CarryWeightAtHealthLevelUp", 0,\
+        "# Set the number of carryweight gained at each health level up.\n"\
+        LEVELED_SETTING_NOTE)\
+    LEVELED(unsigned int, carryWeightAtMagickaLevelUp, "CarryWeightAtMagickaLevelUp", 0,\
+        "# Set the number of carryweight gained at each magicka level up.\n"\
+        LEVELED_SETTING_NOTE)\
+    LEVELED(unsigned int, carryWeightAtStaminaLevelUp, "CarryWeightAtStaminaLevelUp", 5,\
+        "# Set the number of carryweight gained at each stamina level up.\n"\
+        LEVELED_SETTING_NOTE)\
+    SECTION(LegendaryFields, legendary, "LegendarySkill", LEGENDARY_FIELDS)
+
+#endif /* __SKYRIM_UNCAPPER_AE_SETTINGS_SCHEMA_H__ */
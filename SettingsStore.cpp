@@ -0,0 +1,110 @@
+/**
+ * @file SettingsStore.cpp
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Implementation of the settings snapshot store.
+ *
+ * The INI watcher which drives reloads depends on the platform, and lives in
+ * SettingsWatcher.cpp.
+ *
+ * @bug Changes to which patches are enabled still require a restart, as the
+ *      patches are only installed once.
+ */
+
+#include "SettingsStore.h"
+
+#include <thread>
+
+#include "Settings.h"
+
+/// @brief Global settings store, read by the hooks.
+SettingsStore settingsStore;
+
+/**
+ * @brief Creates a store which publishes the settings loaded at startup.
+ */
+SettingsStore::SettingsStore(
+) : current(&settings),
+    epoch(0),
+    watching(false)
+{
+    readers[0] = 0;
+    readers[1] = 0;
+}
+
+/**
+ * @brief Publishes a new settings snapshot, and frees the old one once no hook
+ *        can be reading it.
+ *
+ * The snapshot loaded at startup is the global settings object, and is never
+ * freed.
+ *
+ * @param next The new snapshot, which the store now owns.
+ */
+void
+SettingsStore::Publish(
+    Settings *next
+) {
+    Settings *old = current.exchange(next);
+
+    // New readers register with the other counter, so the old one can only
+    // drain.
+    uint32_t e = epoch.load();
+    epoch.store(e + 1);
+    while (readers[e & 1].load()) {
+        std::this_thread::yield();
+    }
+
+    if (old != &settings) {
+        delete old;
+    }
+}
+
+/**
+ * @brief Reads the INI file into a new snapshot and publishes it.
+ *
+ * If the file can't be read, the current snapshot is kept. Only one thread
+ * may reload at a time.
+ */
+void
+SettingsStore::Reload() {
+    _MESSAGE("Config file changed, reloading...");
+
+    Settings *next = new Settings();
+    if (!next->ReadConfig(path)) {
+        _ERROR("Failed to reload the config file. Keeping the current settings.");
+        delete next;
+        return;
+    }
+
+    // The patches were installed at startup, so the hooks rely on these.
+    next->KeepPatchesFrom(settings);
+
+    Publish(next);
+    _MESSAGE("Config file reloaded.");
+}
+
+/**
+ * @brief Starts reloading the settings whenever the given INI file changes.
+ *
+ * Reads which began before the watcher started are not registered, but they
+ * read the settings loaded at startup, which are never freed.
+ *
+ * @param ini_path The path of the INI file the settings were loaded from.
+ * @return True if the watcher was started.
+ */
+bool
+SettingsStore::Watch(
+    const std::string &ini_path
+) {
+    path = ini_path;
+
+    // Readers must register before the first reload can be published.
+    watching = true;
+    if (!StartWatcher()) {
+        watching = false;
+        return false;
+    }
+
+    _MESSAGE("Watching %s for changes.", path.c_str());
+    return true;
+}
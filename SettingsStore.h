@@ -0,0 +1,119 @@
+/**
+ * @file SettingsStore.h
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Publishes the current settings to the hooks, and reloads them when
+ *        the INI file changes.
+ * @bug No known bugs.
+ */
+
+#ifndef __SKYRIM_UNCAPPER_AE_SETTINGS_STORE_H__
+#define __SKYRIM_UNCAPPER_AE_SETTINGS_STORE_H__
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+class Settings;
+extern Settings settings;
+
+/**
+ * @brief Holds the settings snapshot which the hooks read from.
+ *
+ * Snapshots are never modified once published. A reload builds a new snapshot
+ * and swaps it in with a single atomic store, so readers never take a lock or
+ * see a half-read configuration.
+ *
+ * Old snapshots are reclaimed by epoch: each reader registers with the epoch
+ * it started in, and the writer flips the epoch and waits for the readers of
+ * the old one to leave before deleting the old snapshot. Only the reload
+ * thread publishes snapshots.
+ *
+ * Without hot reloading, the settings loaded at startup are the only snapshot,
+ * so readers use them directly and never touch the shared reader counts.
+ */
+class SettingsStore {
+  private:
+    std::atomic<Settings*> current;
+    std::atomic<uint32_t> epoch;
+    std::atomic<uint32_t> readers[2];
+
+    /// @brief Whether the watcher was started. Watch() runs after the hooks
+    ///        are installed, so the hooks may read this as it changes.
+    std::atomic<bool> watching;
+
+    std::string path;
+
+    bool StartWatcher(void);
+
+  public:
+    SettingsStore();
+
+    /**
+     * @brief Begins a read of the current snapshot.
+     * @param e Returns the epoch to give to Exit().
+     * @return The current snapshot, which is valid until Exit() is called.
+     */
+    inline Settings *
+    Enter(
+        uint32_t &e
+    ) {
+        while (true) {
+            e = epoch.load();
+            readers[e & 1]++;
+
+            // If the epoch flipped under us, the writer may not have seen us.
+            if (epoch.load() == e) {
+                return current.load();
+            }
+
+            readers[e & 1]--;
+        }
+    }
+
+    /// @brief Ends a read started by Enter().
+    inline void Exit(uint32_t e) { readers[e & 1]--; }
+
+    /// @brief Checks if the settings can be replaced while the hooks run.
+    inline bool IsWatching(void) const { return watching.load(); }
+
+    void Publish(Settings *next);
+    void Reload(void);
+    bool Watch(const std::string &ini_path);
+    void RunWatcher(void);
+};
+
+extern SettingsStore settingsStore;
+
+/**
+ * @brief Reads the current settings snapshot for the life of this object.
+ *
+ * Hooks should hold one of these for as long as they use the settings, so that
+ * a reload can't free the snapshot out from under them. When hot reloading is
+ * off, this is just the global settings.
+ */
+class SettingsReader {
+  private:
+    uint32_t e;
+    bool watching;
+    Settings *snapshot;
+
+  public:
+    SettingsReader(
+    ) : e(0),
+        watching(settingsStore.IsWatching()),
+        snapshot(watching ? settingsStore.Enter(e) : &settings)
+    {}
+
+    ~SettingsReader() {
+        if (watching) {
+            settingsStore.Exit(e);
+        }
+    }
+
+    SettingsReader(const SettingsReader &) = delete;
+    SettingsReader &operator=(const SettingsReader &) = delete;
+
+    inline Settings *operator->(void) const { return snapshot; }
+};
+
+#endif /* __SKYRIM_UNCAPPER_AE_SETTINGS_STORE_H__ */
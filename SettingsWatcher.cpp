@@ -0,0 +1,101 @@
+/**
+ * @file SettingsWatcher.cpp
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Windows implementation of the INI watcher, which reloads the settings
+ *        store whenever the INI file is written.
+ * @bug No known bugs.
+ */
+
+#include "SettingsStore.h"
+
+#include <Windows.h>
+
+/// @brief How long to let the INI file settle after a change, in milliseconds.
+static const DWORD kSettleMs = 250;
+
+/**
+ * @brief Gets the last write time of the given file, or 0 if it is missing.
+ */
+static UInt64
+GetWriteTime(
+    const std::string &path
+) {
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &data)) {
+        return 0;
+    }
+
+    return (static_cast<UInt64>(data.ftLastWriteTime.dwHighDateTime) << 32)
+         | data.ftLastWriteTime.dwLowDateTime;
+}
+
+/**
+ * @brief Waits for changes to the directory of the INI file, and reloads the
+ *        settings whenever the INI file itself is written.
+ *
+ * Runs on the watcher thread started by Watch(), and never returns unless
+ * the directory can no longer be watched.
+ */
+void
+SettingsStore::RunWatcher() {
+    std::string dir = path.substr(0, path.find_last_of("/\\") + 1);
+    HANDLE change = FindFirstChangeNotificationA(
+        dir.c_str(),
+        FALSE,
+        FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME
+    );
+    if (change == INVALID_HANDLE_VALUE) {
+        _ERROR("Failed to watch %s for changes: %u", dir.c_str(), (unsigned)GetLastError());
+        return;
+    }
+
+    UInt64 last = GetWriteTime(path);
+    while (WaitForSingleObject(change, INFINITE) == WAIT_OBJECT_0) {
+        // Editors often save in several steps, so let the file settle.
+        Sleep(kSettleMs);
+
+        // Other files in the directory (including our cache) also wake us,
+        // and a missing file is most likely mid-save.
+        UInt64 now = GetWriteTime(path);
+        if (now && (now != last)) {
+            Reload();
+
+            // The reload may have rewritten the file to update it.
+            last = GetWriteTime(path);
+        }
+
+        if (!FindNextChangeNotification(change)) {
+            break;
+        }
+    }
+
+    FindCloseChangeNotification(change);
+}
+
+/**
+ * @brief Entry point of the watcher thread.
+ */
+static DWORD WINAPI
+WatchThread(
+    LPVOID arg
+) {
+    static_cast<SettingsStore*>(arg)->RunWatcher();
+    return 0;
+}
+
+/**
+ * @brief Starts the thread which reloads the settings when the INI file
+ *        changes.
+ * @return True if the thread was started.
+ */
+bool
+SettingsStore::StartWatcher() {
+    HANDLE thread = CreateThread(NULL, 0, WatchThread, this, 0, NULL);
+    if (!thread) {
+        _ERROR("Failed to start the config watcher: %u", (unsigned)GetLastError());
+        return false;
+    }
+
+    CloseHandle(thread);
+    return true;
+}
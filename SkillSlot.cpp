@@ -7,6 +7,8 @@
 
 #include "SkillSlot.h"
 
+#include "NameTable.h"
+
 const char *const SkillSlot::kSkillNames[kCount] = {
     "OneHanded",
     "TwoHanded",
@@ -43,6 +45,34 @@ SkillSlot::FromAttribute(
     return static_cast<t>(static_cast<int>(attr) - kOffset);
 }
 
+/**
+ * @brief Converts the given skill name to a skill enumeration, ignoring case.
+ * @param name The name of the skill, as returned by Str().
+ * @param slot Returns the skill, if the name was valid.
+ * @return True if the name was valid.
+ */
+bool
+SkillSlot::FromName(
+    std::string_view name,
+    t &slot
+) {
+    static const NameTable<t> names = [] {
+        NameTable<t> table;
+        for (int i = 0; i < kCount; i++) {
+            table.Add(kSkillNames[i], static_cast<t>(i));
+        }
+        table.Build();
+        return table;
+    }();
+
+    const t *found = names.Find(name);
+    if (found) {
+        slot = *found;
+    }
+
+    return found != nullptr;
+}
+
 /**
  * @brief Converts the given skill type to a string.
  *
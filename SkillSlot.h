@@ -8,6 +8,8 @@
 #ifndef __SKYRIM_UNCAPPER_AE_SKILL_SLOT_H__
 #define __SKYRIM_UNCAPPER_AE_SKILL_SLOT_H__
 
+#include <string_view>
+
 #include "ActorAttribute.h"
 
 /**
@@ -53,6 +55,7 @@ class SkillSlot {
 
   public:
     static t FromAttribute(ActorAttribute::t attr);
+    static bool FromName(std::string_view name, t &slot);
     static const char *Str(t slot);
 };
 
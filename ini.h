@@ -9,8 +9,13 @@
 #define __SKYRIM_UNCAPPER_AE_INI_H__
 
 #include <string>
-
-#include "simpleini/SimpleIni.h"
+#include <string_view>
+#include <cstring>
+#include <cstdint>
+#include <charconv>
+#include <system_error>
+#include <type_traits>
+#include <vector>
 
 /**
  * @brief Gets the character prefix of a type.
@@ -23,111 +28,398 @@ template <> inline char GetPrefix<bool>() { return 'b'; }
 ///@}
 
 /**
- * @brief Reads a value from an INI file.
+ * @brief Compares two INI section or key names, ignoring case.
+ */
+inline bool
+IniNameEquals(
+    std::string_view a,
+    std::string_view b
+) {
+    return (a.size() == b.size()) && !_strnicmp(a.data(), b.data(), a.size());
+}
+
+/**
+ * @brief Checks if an INI section or key name starts with the given prefix,
+ *        ignoring case.
+ */
+inline bool
+IniNameStartsWith(
+    std::string_view name,
+    std::string_view prefix
+) {
+    return IniNameEquals(name.substr(0, prefix.size()), prefix);
+}
+
+/**
+ * @brief Converts an ASCII letter in an INI name to lower case.
+ */
+constexpr char
+IniLower(
+    char c
+) {
+    return ((c >= 'A') && (c <= 'Z')) ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+/**
+ * @brief Checks that no two of the given INI names are equal, ignoring case.
+ *
+ * Usable at compile time, so that a table of names can be checked with a
+ * static_assert().
+ */
+template <size_t N>
+constexpr bool
+IniNamesUnique(
+    const char *const (&names)[N]
+) {
+    for (size_t i = 0; i < N; i++) {
+        for (size_t j = i + 1; j < N; j++) {
+            const char *a = names[i];
+            const char *b = names[j];
+            while (*a && (IniLower(*a) == IniLower(*b))) {
+                a++;
+                b++;
+            }
+
+            if (!*a && !*b) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Parses a number from the start of the given text with from_chars().
+ *
+ * Leading white space and a leading '+' are skipped, and floating point
+ * numbers may be written in hex, as the C parsing functions which these
+ * replace allowed. Numbers which are out of range are rejected.
+ *
+ * @param text The text to parse.
+ * @param val Returns the number, if one was parsed.
+ * @param base The base of an integer. Ignored for floating point numbers.
+ * @return The number of characters parsed, or 0 if there was no number.
+ */
+template <typename T>
+inline size_t
+ParseIniNumber(
+    std::string_view text,
+    T &val,
+    int base = 10
+) {
+    const char *first = text.data();
+    const char *last = first + text.size();
+    while ((first != last) && ((*first == ' ') || (('\t' <= *first) && (*first <= '\r')))) {
+        first++;
+    }
+    if ((first != last) && (*first == '+')) {
+        if (((last - first) > 1) && (first[1] == '-')) {
+            return 0;
+        }
+        first++;
+    }
+
+    std::from_chars_result res;
+    if constexpr (std::is_floating_point<T>::value) {
+        // from_chars() takes hex floats without the sign and 0x.
+        bool neg = (first != last) && (*first == '-');
+        const char *digits = first + neg;
+        if (((last - digits) > 2) && (digits[0] == '0')
+                && ((digits[1] == 'x') || (digits[1] == 'X')) && (digits[2] != '-')) {
+            res = std::from_chars(digits + 2, last, val, std::chars_format::hex);
+            if ((res.ec == std::errc()) && neg) {
+                val = -val;
+            }
+        } else {
+            res = std::from_chars(first, last, val);
+        }
+    } else {
+        res = std::from_chars(first, last, val, base);
+    }
+
+    return (res.ec == std::errc()) ? static_cast<size_t>(res.ptr - text.data()) : 0;
+}
+
+/**
+ * @brief Parses a value read from an INI file.
+ *
+ * These match the parsing done by the SimpleIni Get*Value() functions. If the
+ * value cannot be parsed, the default is returned.
  */
 ///@{
-template <typename T> inline T ReadIniValue(
-    CSimpleIniA &ini,
-    const char *section,
-    const char *key,
+template <typename T> inline T ParseIniValue(
+    std::string_view value,
     T default_val
 );
 
 template <> inline float
-ReadIniValue<float>(
-    CSimpleIniA &ini,
-    const char *section,
-    const char *key,
+ParseIniValue<float>(
+    std::string_view value,
     float default_val
 ) {
-    return ini.GetDoubleValue(section, key, default_val);
+    double ret;
+    return (!value.empty() && (ParseIniNumber(value, ret) == value.size()))
+        ? static_cast<float>(ret) : default_val;
 }
 
 template <> inline unsigned int
-ReadIniValue<unsigned int>(
-    CSimpleIniA &ini,
-    const char *section,
-    const char *key,
+ParseIniValue<unsigned int>(
+    std::string_view value,
     unsigned int default_val
 ) {
-    return ini.GetLongValue(section, key, default_val);
+    // Values starting with 0x are hex.
+    int base = 10;
+    if ((value.size() > 2) && (value[0] == '0') && ((value[1] == 'x') || (value[1] == 'X'))) {
+        value.remove_prefix(2);
+        base = 16;
+    }
+
+    // Negative values wrap, as they did with strtol().
+    int64_t ret;
+    return (!value.empty() && (ParseIniNumber(value, ret, base) == value.size()))
+        ? static_cast<unsigned int>(ret) : default_val;
 }
 
 template <> inline bool
-ReadIniValue<bool>(
-    CSimpleIniA &ini,
-    const char *section,
-    const char *key,
+ParseIniValue<bool>(
+    std::string_view value,
     bool default_val
 ) {
-    return ini.GetBoolValue(section, key, default_val);
+    if (value.empty()) {
+        return default_val;
+    }
+
+    switch (value[0]) {
+        case 't': case 'T':
+        case 'y': case 'Y':
+        case '1':
+            return true;
+        case 'f': case 'F':
+        case 'n': case 'N':
+        case '0':
+            return false;
+        case 'o': case 'O':
+            if ((value.size() > 1) && ((value[1] == 'n') || (value[1] == 'N'))) {
+                return true;
+            } else if ((value.size() > 1) && ((value[1] == 'f') || (value[1] == 'F'))) {
+                return false;
+            }
+            break;
+        default:
+            break;
+    }
+
+    return default_val;
 }
 
 template <> inline std::string
-ReadIniValue<std::string>(
-    CSimpleIniA &ini,
-    const char *section,
-    const char *key,
+ParseIniValue<std::string>(
+    std::string_view value,
     std::string default_val
 ) {
-    return std::string(ini.GetValue(section, key, default_val.c_str()));
+    (void)default_val;
+    return std::string(value);
 }
 ///@}
 
+/**
+ * @brief Parses the level of a leveled setting key, in the same way as atoi().
+ *
+ * Any text after the leading number is ignored.
+ */
+inline unsigned int
+ParseIniLevel(
+    std::string_view key
+) {
+    int level = 0;
+    ParseIniNumber(key, level);
+    return static_cast<unsigned int>(level);
+}
+
+/**
+ * @brief Writes out an INI file in a single pass, in the order the entries are
+ *        given.
+ *
+ * The output is laid out as SimpleIni laid it out: sections are separated by a
+ * blank line, each comment gets a blank line above it, and entries are written
+ * as "key = value". All the entries of a section must be written together.
+ *
+ * A writer can also update an existing file. The file is scanned once, and
+ * each entry written then either replaces the value of the same key in place,
+ * is added to the end of its section, or goes into a new section at the end of
+ * the file. Everything else in the file, including comments, is kept as is.
+ */
+class IniWriter {
+  private:
+    /// @brief A section of the existing file.
+    struct BaseSection {
+        std::string_view name;
+        size_t end;
+        uint32_t first;
+        uint32_t count;
+    };
+
+    /// @brief An entry of the existing file, grouped by section.
+    struct BaseEntry {
+        uint32_t section;
+        std::string_view key;
+        std::string_view value;
+    };
+
+    /// @brief Replaces a range of the existing file with some added text.
+    struct Splice {
+        size_t start;
+        size_t end;
+        size_t textPos;
+        size_t textLen;
+        bool insert;
+    };
+
+    const char *base;
+    size_t baseSize;
+    std::vector<BaseSection> sections;
+    std::vector<BaseEntry> entries;
+    std::vector<Splice> splices;
+    std::string spliced;
+    mutable size_t lastSection;
+    const char *newLine;
+
+    std::string out;
+    size_t sectionPos;
+    size_t sectionLen;
+
+    void WriteLines(std::string &dst, const char *text) const;
+    void WriteEntry(
+        std::string &dst,
+        std::string_view key,
+        std::string_view value,
+        const char *comment
+    ) const;
+
+    const BaseSection *FindSection(std::string_view section) const;
+    const std::string_view *FindValue(std::string_view section, std::string_view key) const;
+
+  public:
+    explicit IniWriter(size_t reserve);
+    IniWriter(const char *data, size_t size);
+
+    /// @brief Checks if the file being updated has any entries in a section.
+    inline bool
+    HasSection(
+        const char *section
+    ) const {
+        const BaseSection *sec = FindSection(section);
+        return sec && sec->count;
+    }
+
+    /**
+     * @brief Checks if the file being updated already holds the given value.
+     *
+     * Values are compared as they would be read, so the way the user wrote a
+     * value is kept.
+     */
+    template <typename T>
+    bool
+    Keeps(
+        const char *section,
+        std::string_view key,
+        T val
+    ) const {
+        const std::string_view *old = FindValue(section, key);
+        return old && (ParseIniValue(*old, val) == val);
+    }
+
+    void Write(
+        const char *section,
+        std::string_view key,
+        std::string_view value,
+        const char *comment
+    );
+
+    void Finish(void);
+    bool Save(const std::string &path);
+};
+
 /**
  * @brief Writes a value to an INI file.
+ *
+ * Numbers are formatted on the stack, as SimpleIni formatted them. Values which
+ * the file being updated already holds are skipped.
  */
 ///@{
 template <typename T> inline void SaveIniValue(
-    CSimpleIniA &ini,
+    IniWriter &ini,
     const char *section,
-    const char *key,
+    std::string_view key,
     T val,
     const char *comment
 );
 
 template <> inline void
 SaveIniValue<float>(
-    CSimpleIniA &ini,
+    IniWriter &ini,
     const char *section,
-    const char *key,
+    std::string_view key,
     float val,
     const char *comment
 ) {
-    ASSERT(ini.SetDoubleValue(section, key, val, comment));
+    if (ini.Keeps(section, key, val)) {
+        return;
+    }
+
+    char buf[64];
+    auto res = std::to_chars(buf, buf + sizeof(buf), static_cast<double>(val), std::chars_format::fixed, 6);
+    ASSERT(res.ec == std::errc());
+    ini.Write(section, key, std::string_view(buf, res.ptr - buf), comment);
 }
 
 template <> inline void
 SaveIniValue<unsigned int>(
-    CSimpleIniA &ini,
+    IniWriter &ini,
     const char *section,
-    const char *key,
+    std::string_view key,
     unsigned int val,
     const char *comment
 ) {
-    ASSERT(ini.SetLongValue(section, key, val, comment));
+    if (ini.Keeps(section, key, val)) {
+        return;
+    }
+
+    char buf[16];
+    auto res = std::to_chars(buf, buf + sizeof(buf), val);
+    ASSERT(res.ec == std::errc());
+    ini.Write(section, key, std::string_view(buf, res.ptr - buf), comment);
 }
 
 template <> inline void
 SaveIniValue<bool>(
-    CSimpleIniA &ini,
+    IniWriter &ini,
     const char *section,
-    const char *key,
+    std::string_view key,
     bool val,
     const char *comment
 ) {
-    ASSERT(ini.SetBoolValue(section, key, val, comment));
+    if (ini.Keeps(section, key, val)) {
+        return;
+    }
+
+    ini.Write(section, key, val ? "true" : "false", comment);
 }
 
 template <> inline void
 SaveIniValue<std::string>(
-    CSimpleIniA &ini,
+    IniWriter &ini,
     const char *section,
-    const char *key,
+    std::string_view key,
     std::string val,
     const char *comment
 ) {
-    ASSERT(ini.SetValue(section, key, val.c_str(), comment));
+    if (ini.Keeps(section, key, val)) {
+        return;
+    }
+
+    ini.Write(section, key, val, comment);
 }
 ///@}
 
@@ -166,16 +458,30 @@ class SectionField {
     }
 
     /**
-     * @brief Reads in the value from the given INI file.
-     * @param ini The INI to read the value from.
-     * @param section The section to read the value from.
+     * @brief Resets the field to its default value.
      */
-    void
-    ReadConfig(
-        CSimpleIniA &ini,
-        const char *section
+    inline void
+    Reset() {
+        val = defaultVal;
+    }
+
+    /**
+     * @brief Reads in the value of an INI entry, if it belongs to this field.
+     * @param key The key of the entry.
+     * @param value The value of the entry.
+     * @return True if the entry belonged to this field.
+     */
+    bool
+    ReadEntry(
+        std::string_view key,
+        std::string_view value
     ) {
-        val = ReadIniValue(ini, section, name, defaultVal);
+        if (!IniNameEquals(key, name)) {
+            return false;
+        }
+
+        val = ParseIniValue(value, defaultVal);
+        return true;
     }
 
     /**
@@ -185,7 +491,7 @@ class SectionField {
      */
     void
     SaveConfig(
-        CSimpleIniA &ini,
+        IniWriter &ini,
         const char *section,
         const char *comment
     ) {
@@ -193,4 +499,28 @@ class SectionField {
     }
 };
 
+/**
+ * @brief Splits the contents of an INI file into its entries, in a single pass
+ *        and without copying.
+ *
+ * The syntax accepted is the same as the SimpleIni defaults: comment lines
+ * start with ';' or '#', names and values are trimmed, keys without a value
+ * are skipped, and entries before the first section belong to the section "".
+ */
+class IniTokenizer {
+  private:
+    const char *pos;
+    const char *end;
+    std::string_view section;
+    bool headers;
+
+    static std::string_view TrimEnd(const char *start, const char *stop);
+    void SkipLine(void);
+
+  public:
+    IniTokenizer(const char *data, size_t size, bool headers = false);
+
+    bool Next(std::string_view &sec, std::string_view &key, std::string_view &value);
+};
+
 #endif /* __SKYRIM_UNCAPPER_AE_INI_H__ */
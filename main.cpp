@@ -15,7 +15,9 @@
 #include "skse_version.h"
 
 #include "RelocPatch.h"
+#include "HookTrace.h"
 #include "Settings.h"
+#include "SettingsStore.h"
 
 #define DLL_EXPORT __declspec(dllexport)
 
@@ -68,21 +70,31 @@ static bool SkyrimUncapper_Initialize(const SKSEInterface* skse)
     );
     _MESSAGE("imagebase = %016I64X", img_base);
 
-    std::string path;
-    if (!GetDllDirWithSlash(path)) {
+    std::string dir;
+    if (!GetDllDirWithSlash(dir)) {
         return false;
     }
 
-    path += "SkyrimUncapper.ini";
+    std::string path = dir + "SkyrimUncapper.ini";
     if (!settings.ReadConfig(path)) {
         return false;
     }
 
+    // Recording must start before the hooks can run.
+    if (settings.IsHookTraceEnabled()) {
+        hookTrace.Start(dir + "SkyrimUncapper.trace");
+    }
+
     if (ApplyGamePatches(img_base, skse->runtimeVersion) < 0) {
         _ERROR("Failed to apply game patches. See log for details.");
         return false;
     }
 
+    // Reloaded settings are published to the hooks as they're read.
+    if (settings.IsHotReloadEnabled()) {
+        settingsStore.Watch(path);
+    }
+
     _MESSAGE("Init complete");
     return true;
 }
@@ -0,0 +1,205 @@
+/**
+ * @file AttributeLevelUpTest.cpp
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Checks the attribute level up table against the per-level list
+ *        searches it replaced, over random settings.
+ * @bug No known bugs.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Settings.h"
+#include "AttributeLevelUpTable.h"
+
+/// @brief The highest level each table is checked up to.
+static const unsigned int kMaxCheckLevel = 10000;
+
+/// @brief The highest level a random setting may have an entry at, which is
+///        past the dense part of the table.
+static const unsigned int kMaxEntryLevel = 9000;
+
+/// @brief The most entries a random setting may have.
+static const unsigned int kMaxEntries = 24;
+
+/// @brief The number of settings which make up a table.
+static const size_t kSourceCount =
+    AttributeLevelUpTable::kChoiceCount * AttributeLevelUpTable::kGainCount;
+
+/// @brief An entry of a leveled setting, as the old search stored it.
+struct GainEntry {
+    unsigned int level;
+    unsigned int item;
+};
+
+/**
+ * @brief The gain at a level as it was found before the table was compiled,
+ *        by a binary search of the setting's list.
+ *
+ * The list must be sorted by level, and start at level 0.
+ */
+static unsigned int
+OldGetNearest(
+    const std::vector<GainEntry> &list,
+    unsigned int level
+) {
+    ASSERT(list.size() > 0);
+
+    size_t lo = 0, hi = list.size();
+    size_t mid = lo + ((hi - lo) >> 1);
+    while (lo < hi) {
+        ASSERT(mid < list.size());
+        if ((list[mid].level <= level)
+                && ((mid + 1 == list.size()) || (level < list[mid + 1].level))) {
+            return list[mid].item;
+        } else if (level < list[mid].level) {
+            hi = mid;
+        } else {
+            ASSERT((level > list[mid].level) || (level >= list[mid + 1].level));
+            lo = mid + 1;
+        }
+
+        mid = lo + ((hi - lo) >> 1);
+    }
+
+    // If no direct match was found, return the closest lo item.
+    return list[lo].item;
+}
+
+/**
+ * @brief Builds a random setting, and reads it in as INI entries.
+ *
+ * Level 0 is left out about half of the time, so that the default fills it
+ * in. Some settings only have entries within the dense part of the table,
+ * and some only have a few entries, so that runs of equal gains are common.
+ * One in four settings is interpolated.
+ *
+ * @param rng The random source.
+ * @param def The default value of the setting.
+ * @param setting Returns the setting, which has been read but not placed.
+ * @return The sorted list of the setting, as the old search stored it, or
+ *         an empty list if the setting is interpolated.
+ */
+static std::vector<GainEntry>
+RandomSetting(
+    std::mt19937 &rng,
+    unsigned int def,
+    LeveledSetting<unsigned int> &setting
+) {
+    std::uniform_int_distribution<unsigned int> count_dist(0, kMaxEntries);
+    std::uniform_int_distribution<unsigned int> value_dist(0, 50);
+    unsigned int max_level = (rng() & 1) ? kMaxEntryLevel : 200;
+    std::uniform_int_distribution<unsigned int> level_dist(1, max_level);
+
+    std::vector<GainEntry> list;
+    if (rng() & 1) {
+        list.push_back({ 0, value_dist(rng) });
+    }
+
+    unsigned int count = count_dist(rng);
+    for (unsigned int i = 0; i < count; i++) {
+        list.push_back({ level_dist(rng), value_dist(rng) });
+    }
+
+    bool blended = (rng() % 4) == 0;
+    setting.BeginRead(def);
+    if (blended) {
+        setting.ReadEntry("Interpolation", (rng() & 1) ? "Linear" : "Cubic");
+    }
+    for (const GainEntry &entry : list) {
+        setting.ReadEntry(std::to_string(entry.level), std::to_string(entry.item));
+    }
+    setting.EndRead();
+
+    if (blended) {
+        return std::vector<GainEntry>();
+    }
+
+    // The first entry of a level is the one which is kept.
+    std::stable_sort(list.begin(), list.end(), [](const GainEntry &a, const GainEntry &b) {
+        return a.level < b.level;
+    });
+    list.erase(std::unique(list.begin(), list.end(), [](const GainEntry &a, const GainEntry &b) {
+        return a.level == b.level;
+    }), list.end());
+
+    if (list.empty() || (list[0].level != 0)) {
+        list.insert(list.begin(), { 0, def });
+    }
+
+    return list;
+}
+
+int
+main(
+    int argc,
+    char **argv
+) {
+    static const ActorAttribute::t kChoices[AttributeLevelUpTable::kChoiceCount] = {
+        ActorAttribute::Health,
+        ActorAttribute::Magicka,
+        ActorAttribute::Stamina
+    };
+
+    unsigned int runs = (argc > 1) ? static_cast<unsigned int>(atoi(argv[1])) : 200;
+    std::mt19937 rng(20240611);
+    unsigned int failures = 0;
+
+    for (unsigned int run = 0; run < runs; run++) {
+        LeveledSetting<unsigned int> settings[kSourceCount];
+        std::vector<GainEntry> lists[kSourceCount];
+        size_t arena_size = 0;
+        for (size_t i = 0; i < kSourceCount; i++) {
+            lists[i] = RandomSetting(rng, static_cast<unsigned int>(i), settings[i]);
+            arena_size += settings[i].ArenaSize();
+        }
+
+        LeveledArena arena;
+        arena.Reset(arena_size);
+        for (size_t i = 0; i < kSourceCount; i++) {
+            settings[i].Place(arena);
+        }
+        for (size_t i = 0; i < kSourceCount; i++) {
+            bool bound = settings[i].Bind(arena);
+            ASSERT(bound);
+        }
+
+        AttributeLevelUpTable::Sources src = {
+            { &settings[0], &settings[1], &settings[2], &settings[3] },
+            { &settings[4], &settings[5], &settings[6], &settings[7] },
+            { &settings[8], &settings[9], &settings[10], &settings[11] }
+        };
+        AttributeLevelUpTable table;
+        table.Compile(src);
+
+        bool bad = false;
+        for (unsigned int level = 1; !bad && (level <= kMaxCheckLevel); level++) {
+            for (size_t c = 0; !bad && (c < AttributeLevelUpTable::kChoiceCount); c++) {
+                // Interpolated settings are checked against their own
+                // values, as the old search could only step.
+                const ActorAttributeLevelUp &got = table.Get(level, kChoices[c]);
+                float want[AttributeLevelUpTable::kGainCount];
+                for (size_t g = 0; g < AttributeLevelUpTable::kGainCount; g++) {
+                    size_t i = c * AttributeLevelUpTable::kGainCount + g;
+                    want[g] = static_cast<float>(
+                        lists[i].empty() ? settings[i].Get(level) : OldGetNearest(lists[i], level)
+                    );
+                }
+                bad = (got.health != want[0]) || (got.magicka != want[1])
+                    || (got.stamina != want[2]) || (got.carry_weight != want[3]);
+
+                if (bad && (failures++ < 10)) {
+                    printf("run %u: level %u choice %zu does not match the settings\n",
+                           run, level, c);
+                }
+            }
+        }
+    }
+
+    printf("AttributeLevelUpTest: %u tables, %u failures.\n", runs, failures);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,585 @@
+/**
+ * @file ConfigSearch.cpp
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Searches for the settings which best meet a progression target, and
+ *        writes them out as an INI file.
+ *
+ * Usage: ConfigSearch <ini path> [level] [skill uses] [max perks] [perk level]
+ *                     [candidates] [threads]
+ *
+ * The target is to reach the given level in about the given number of skill
+ * uses, while giving at most the given number of perks by the perk level. The
+ * defaults are level 81 in 30000 uses, with at most 120 perks at level 100.
+ *
+ * Each candidate sets the skill and level exp multipliers of every skill, and
+ * a perk list of kPerkBreaks levels. Every other setting is left at its
+ * default, which the search reads once through the real settings and then
+ * shares between the threads. A candidate only scales the compiled
+ * multipliers and sums its own perk list, so nothing is parsed or compiled
+ * while searching.
+ *
+ * A candidate is scored by how far the characters of ProgressionSim are from
+ * the target number of uses when they reach the level, and by how far its
+ * perks are below the limit. Candidates which give too many perks are
+ * rejected before they are played, and a character stops playing once the
+ * candidate can no longer beat the best one found so far.
+ *
+ * The first round samples the whole space, and each round after it samples
+ * closer around the best candidate of the one before. Candidates are drawn in
+ * batches, each from its own seed, so the result doesn't depend on how many
+ * threads are used.
+ *
+ * The best candidate is written to the INI file, which is then read back
+ * through the settings to fill in everything else, and replayed under them
+ * to check that it scores the same.
+ *
+ * @bug No known bugs.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Settings.h"
+#include "Progression.h"
+#include "TestFiles.h"
+#include "Vanilla.h"
+
+typedef std::chrono::steady_clock Clock;
+
+/// @brief The seed of the first character, as in ProgressionSim.
+static const unsigned int kSeed = 20240618;
+
+/// @brief The seed the candidates are drawn from.
+static const unsigned int kSearchSeed = 20240621;
+
+/// @brief The number of characters each candidate is played with.
+static const unsigned int kCharacters = 4;
+
+/// @brief The number of rounds, and how much closer each samples than the
+///        last.
+static const unsigned int kRounds = 4;
+static const float kRoundShrink = 0.4f;
+
+/// @brief The number of candidates drawn from one seed.
+static const unsigned int kBatchSize = 32;
+
+/// @brief The number of levels in a candidate's perk list.
+static const unsigned int kPerkBreaks = 3;
+
+/// @brief The range of the exp multipliers, in percent.
+static const unsigned int kMinExpPercent = 25;
+static const unsigned int kMaxExpPercent = 400;
+
+/// @brief The most perks a candidate gives per level, in tenths.
+static const unsigned int kMaxPerkTenths = 30;
+
+/// @brief Characters stop once they take this many times the target uses.
+static const unsigned int kMaxUsesRatio = 2;
+
+/// @brief How much a perk below the limit counts against a candidate, as a
+///        fraction of the limit, against a miss of the target uses.
+static const float kPerkWeight = 0.1f;
+
+/// @brief The score of a candidate which was rejected.
+static const float kRejected = INFINITY;
+
+/// @brief The target the search tries to meet.
+struct Target {
+    unsigned int level;
+    unsigned int uses;
+    unsigned int maxPerks;
+    unsigned int perkLevel;
+};
+
+/// @brief A skill use of a character, drawn before the search.
+struct Action {
+    SkillSlot::t slot;
+    float exp;
+};
+
+/**
+ * @brief The skill uses and attribute choices of one character, shared by
+ *        every candidate so that candidates are compared on the same play.
+ */
+struct Playthrough {
+    std::vector<Action> actions;
+    std::vector<ActorAttribute::t> choices;
+    bool legendary;
+};
+
+/// @brief The settings a candidate searches.
+struct Candidate {
+    unsigned int skillExpPercent;
+    unsigned int levelExpPercent;
+
+    /// @brief The levels of the perk list. The first is always 0.
+    unsigned int perkLevels[kPerkBreaks];
+
+    /// @brief The perks given from each level of the list, in tenths.
+    unsigned int perkTenths[kPerkBreaks];
+};
+
+/// @brief The best candidate a thread found in a round, kept on its own cache
+///        line.
+struct alignas(64) RoundBest {
+    float score;
+    uint64_t index;
+    Candidate candidate;
+    uint64_t rejected;
+};
+
+/// @brief The best score found so far by any thread. Only used to reject
+///        candidates, so it doesn't change the result.
+static std::atomic<float> bestScore(kRejected);
+
+/**
+ * @brief Lowers the best score found so far.
+ */
+static void
+LowerBestScore(
+    float score
+) {
+    float cur = bestScore.load(std::memory_order_relaxed);
+    while ((score < cur) && !bestScore.compare_exchange_weak(cur, score, std::memory_order_relaxed)) {}
+}
+
+/**
+ * @brief Draws the play of a character, as ProgressionSim's characters play.
+ */
+static Playthrough
+DrawPlaythrough(
+    unsigned int character,
+    const Target &target
+) {
+    std::mt19937 rng(kSeed + character);
+    Playstyle style(rng, (character & 1) != 0);
+
+    Playthrough p;
+    p.legendary = style.legendary;
+    for (unsigned int i = 0; i < target.uses * kMaxUsesRatio; i++) {
+        SkillSlot::t slot = style.NextSkill(rng);
+        p.actions.push_back({ slot, style.NextExp(slot, rng) });
+    }
+
+    for (unsigned int i = 0; i < target.level; i++) {
+        p.choices.push_back(style.NextChoice(rng));
+    }
+
+    return p;
+}
+
+/**
+ * @brief Plays a character until they reach the given level.
+ * @param max_uses The most skill uses to play.
+ * @return The number of uses it took, or max_uses + 1 if the level wasn't
+ *         reached.
+ */
+static unsigned int
+PlayToLevel(
+    const Playthrough &p,
+    const ExpScales &scales,
+    unsigned int level,
+    unsigned int max_uses
+) {
+    Character c;
+    StartCharacter(c);
+    for (unsigned int use = 0; use < max_uses; use++) {
+        const Action &action = p.actions[use];
+        ImproveSkill(c, action.slot, action.exp, p.legendary, scales);
+
+        while (c.levelExp >= VanillaLevelThreshold(c.level)) {
+            LevelUp(c, p.choices[c.level]);
+            if (c.level >= level) {
+                return use + 1;
+            }
+        }
+    }
+
+    return max_uses + 1;
+}
+
+/**
+ * @brief Gets the fixed-point sum of a candidate's perk list over every level
+ *        up to the given one, in tenths.
+ */
+static unsigned int
+PerkTenthsTo(
+    const Candidate &cand,
+    unsigned int level
+) {
+    unsigned int total = 0;
+    for (unsigned int i = 0; (i < kPerkBreaks) && (cand.perkLevels[i] <= level); i++) {
+        unsigned int end = ((i + 1) < kPerkBreaks) ? MIN(cand.perkLevels[i + 1] - 1, level) : level;
+        total += (end - cand.perkLevels[i] + 1) * cand.perkTenths[i];
+    }
+
+    return total;
+}
+
+/**
+ * @brief Gets the perks a candidate gives for the level ups up to the given
+ *        level, which carry their fractions over as the perk schedule does.
+ */
+static unsigned int
+CandidatePerks(
+    const Candidate &cand,
+    unsigned int level
+) {
+    return (PerkTenthsTo(cand, level) / 10) - (PerkTenthsTo(cand, 1) / 10);
+}
+
+/**
+ * @brief Scores a miss of the target uses by the given characters.
+ */
+static float
+UsesScore(
+    unsigned int uses,
+    const Target &target
+) {
+    float miss = static_cast<float>(uses) - static_cast<float>(target.uses);
+    return std::fabs(miss) / (target.uses * kCharacters);
+}
+
+/**
+ * @brief Scores a candidate. Lower is better.
+ * @return The score, or kRejected if the candidate gives too many perks or
+ *         can't beat the best score found so far.
+ */
+static float
+Score(
+    const Candidate &cand,
+    const std::vector<Playthrough> &plays,
+    const Target &target
+) {
+    unsigned int perks = CandidatePerks(cand, target.perkLevel);
+    if (perks > target.maxPerks) {
+        return kRejected;
+    }
+
+    float score = kPerkWeight * (target.maxPerks - perks) / target.maxPerks;
+    ExpScales scales = {
+        static_cast<float>(cand.skillExpPercent) / 100,
+        static_cast<float>(cand.levelExpPercent) / 100
+    };
+
+    for (const Playthrough &p : plays) {
+        // Play no further than the uses which would lose to the best score.
+        // One more use is played, so that rounding never rejects a candidate
+        // which ties it.
+        float slack = bestScore.load(std::memory_order_relaxed) - score;
+        if (slack < 0) {
+            return kRejected;
+        }
+
+        float max_miss = MIN(slack * target.uses * kCharacters + 1, static_cast<float>(target.uses));
+
+        unsigned int max_uses = target.uses + static_cast<unsigned int>(max_miss);
+        unsigned int uses = PlayToLevel(p, scales, target.level, max_uses);
+        if (uses > max_uses) {
+            return kRejected;
+        }
+
+        score += UsesScore(uses, target);
+    }
+
+    return score;
+}
+
+/**
+ * @brief Draws a whole number around another, within the given bounds.
+ * @param radius How far from the center to draw, as a fraction of the range.
+ */
+static unsigned int
+DrawNear(
+    std::mt19937 &rng,
+    unsigned int center,
+    unsigned int lo,
+    unsigned int hi,
+    float radius
+) {
+    int reach = MAX(1, static_cast<int>(std::lround((hi - lo) * radius)));
+    std::uniform_int_distribution<int> dist(-reach, reach);
+    int val = static_cast<int>(center) + dist(rng);
+    return static_cast<unsigned int>(MAX(static_cast<int>(lo), MIN(static_cast<int>(hi), val)));
+}
+
+/**
+ * @brief Draws a candidate around another.
+ *
+ * A radius of 1 or more draws from the whole space. The perk levels after the
+ * first stay in order, and within twice the perk level of the target.
+ */
+static Candidate
+DrawCandidate(
+    std::mt19937 &rng,
+    const Candidate &center,
+    float radius,
+    const Target &target
+) {
+    Candidate cand;
+    unsigned int max_level = target.perkLevel * 2;
+    if (radius >= 1) {
+        std::uniform_int_distribution<unsigned int> exp_dist(kMinExpPercent, kMaxExpPercent);
+        std::uniform_int_distribution<unsigned int> tenths_dist(0, kMaxPerkTenths);
+        cand.skillExpPercent = exp_dist(rng);
+        cand.levelExpPercent = exp_dist(rng);
+        for (unsigned int i = 0; i < kPerkBreaks; i++) {
+            cand.perkLevels[i] = (i == 0) ? 0 : std::uniform_int_distribution<unsigned int>(
+                cand.perkLevels[i - 1] + 1,
+                max_level - kPerkBreaks + i
+            )(rng);
+            cand.perkTenths[i] = tenths_dist(rng);
+        }
+        return cand;
+    }
+
+    cand.skillExpPercent = DrawNear(rng, center.skillExpPercent, kMinExpPercent, kMaxExpPercent, radius);
+    cand.levelExpPercent = DrawNear(rng, center.levelExpPercent, kMinExpPercent, kMaxExpPercent, radius);
+    for (unsigned int i = 0; i < kPerkBreaks; i++) {
+        cand.perkLevels[i] = (i == 0) ? 0 : DrawNear(
+            rng,
+            MAX(center.perkLevels[i], cand.perkLevels[i - 1] + 1),
+            cand.perkLevels[i - 1] + 1,
+            max_level - kPerkBreaks + i,
+            radius
+        );
+        cand.perkTenths[i] = DrawNear(rng, center.perkTenths[i], 0, kMaxPerkTenths, radius);
+    }
+
+    return cand;
+}
+
+/**
+ * @brief Writes out the settings of a candidate as an INI file.
+ *
+ * Only the settings the candidate searches are written. Reading the file back
+ * through the settings fills in everything else, as it would for an INI file
+ * from an older version.
+ */
+static std::string
+CandidateIni(
+    const Candidate &cand,
+    const Target &target
+) {
+    char buf[160];
+    sprintf_s(buf, "# Found by ConfigSearch to reach level %u in about %u skill uses,\n"
+                   "# with at most %u perks at level %u.\n",
+              target.level, target.uses, target.maxPerks, target.perkLevel);
+    std::string ini = buf;
+
+    static const char *const kSections[] = { "SkillExpGainMults", "LevelSkillExpMults" };
+    const unsigned int percents[] = { cand.skillExpPercent, cand.levelExpPercent };
+    for (unsigned int s = 0; s < 2; s++) {
+        ini += std::string("\n[") + kSections[s] + "]\n";
+        for (size_t i = 0; i < SkillSlot::kCount; i++) {
+            sprintf_s(buf, "f%s = %u.%02u\n", SkillSlot::Str(static_cast<SkillSlot::t>(i)),
+                      percents[s] / 100, percents[s] % 100);
+            ini += buf;
+        }
+    }
+
+    ini += "\n[PerksAtLevelUp]\n";
+    for (unsigned int i = 0; i < kPerkBreaks; i++) {
+        sprintf_s(buf, "%u = %u.%u\n", cand.perkLevels[i], cand.perkTenths[i] / 10, cand.perkTenths[i] % 10);
+        ini += buf;
+    }
+
+    return ini;
+}
+
+/**
+ * @brief Prints a candidate and how its characters play under it.
+ */
+static void
+PrintCandidate(
+    const Candidate &cand,
+    float score,
+    const std::vector<Playthrough> &plays,
+    const Target &target
+) {
+    printf("score %.5f: skill exp x%.2f, level exp x%.2f, %u perks by level %u, perks",
+           score, cand.skillExpPercent / 100.0, cand.levelExpPercent / 100.0,
+           CandidatePerks(cand, target.perkLevel), target.perkLevel);
+    for (unsigned int i = 0; i < kPerkBreaks; i++) {
+        printf(" %u=%u.%u", cand.perkLevels[i], cand.perkTenths[i] / 10, cand.perkTenths[i] % 10);
+    }
+
+    printf("\nuses to level %u:", target.level);
+    ExpScales scales = {
+        static_cast<float>(cand.skillExpPercent) / 100,
+        static_cast<float>(cand.levelExpPercent) / 100
+    };
+    for (const Playthrough &p : plays) {
+        printf(" %u", PlayToLevel(p, scales, target.level, target.uses * kMaxUsesRatio));
+    }
+    printf("\n");
+}
+
+/**
+ * @brief Reads the written INI file back, and scores the candidate again
+ *        under the settings it gives.
+ * @return True if the settings give the same perks and score.
+ */
+static bool
+Verify(
+    const std::string &path,
+    const Candidate &cand,
+    float score,
+    const std::vector<Playthrough> &plays,
+    const Target &target
+) {
+    if (!settings.ReadConfig(path)) {
+        fprintf(stderr, "Failed to read back %s.\n", path.c_str());
+        return false;
+    }
+
+    unsigned int perks = 0;
+    for (unsigned int level = 2; level <= target.perkLevel; level++) {
+        perks += settings.GetPerkDelta(level);
+    }
+
+    float verified = kPerkWeight * (target.maxPerks - perks) / target.maxPerks;
+    for (const Playthrough &p : plays) {
+        unsigned int uses = PlayToLevel(p, kNoExpScales, target.level, target.uses * kMaxUsesRatio);
+        verified += UsesScore(uses, target);
+    }
+
+    if ((perks != CandidatePerks(cand, target.perkLevel)) || (verified != score)) {
+        fprintf(stderr, "The settings read from %s give %u perks and score %.5f, not %u and %.5f.\n",
+                path.c_str(), perks, verified, CandidatePerks(cand, target.perkLevel), score);
+        return false;
+    }
+
+    return true;
+}
+
+int
+main(
+    int argc,
+    char **argv
+) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <ini path> [level] [skill uses] [max perks] [perk level] "
+                        "[candidates] [threads]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::string path = argv[1];
+    Target target = {
+        (argc > 2) ? static_cast<unsigned int>(atoi(argv[2])) : 81,
+        (argc > 3) ? static_cast<unsigned int>(atoi(argv[3])) : 30000,
+        (argc > 4) ? static_cast<unsigned int>(atoi(argv[4])) : 120,
+        (argc > 5) ? static_cast<unsigned int>(atoi(argv[5])) : 100
+    };
+    unsigned int candidates = (argc > 6) ? static_cast<unsigned int>(atoi(argv[6])) : 1024;
+    unsigned int threads = (argc > 7)
+        ? static_cast<unsigned int>(atoi(argv[7]))
+        : std::thread::hardware_concurrency();
+    threads = (threads > 0) ? threads : 1;
+    unsigned int batches = (candidates + kBatchSize - 1) / kBatchSize;
+
+    if ((target.level < 2) || !target.uses || !target.maxPerks || (target.perkLevel < kPerkBreaks)) {
+        fprintf(stderr, "The level and perk level must be at least 2 and %u, and the uses and "
+                        "perks more than 0.\n", kPerkBreaks);
+        return EXIT_FAILURE;
+    }
+
+    // An empty file reads as the default settings, which every candidate
+    // builds on.
+    WriteTestFile(path, "");
+    if (!settings.ReadConfig(path)) {
+        fprintf(stderr, "Failed to load %s.\n", path.c_str());
+        return EXIT_FAILURE;
+    }
+
+    std::vector<Playthrough> plays;
+    for (unsigned int i = 0; i < kCharacters; i++) {
+        plays.push_back(DrawPlaythrough(i, target));
+    }
+
+    // The settings are only read from here on, so the threads can share them.
+    Candidate best = {};
+    float best_score = kRejected;
+    float radius = 1;
+    for (unsigned int round = 0; round < kRounds; round++) {
+        std::vector<RoundBest> bests(threads);
+        std::atomic<unsigned int> next(0);
+        std::vector<std::thread> workers;
+
+        Clock::time_point start = Clock::now();
+        for (unsigned int t = 0; t < threads; t++) {
+            workers.emplace_back([&, t]() {
+                RoundBest &mine = bests[t];
+                mine.score = kRejected;
+                mine.index = 0;
+                mine.rejected = 0;
+
+                std::mt19937 rng;
+                unsigned int batch;
+                while ((batch = next++) < batches) {
+                    std::seed_seq seed = { kSearchSeed, round, batch };
+                    rng.seed(seed);
+                    for (unsigned int i = batch * kBatchSize; i < MIN(candidates, (batch + 1) * kBatchSize); i++) {
+                        Candidate cand = DrawCandidate(rng, best, radius, target);
+                        float score = Score(cand, plays, target);
+                        if (score == kRejected) {
+                            mine.rejected++;
+                        } else if ((score < mine.score) || ((score == mine.score) && (i < mine.index))) {
+                            mine.score = score;
+                            mine.index = i;
+                            mine.candidate = cand;
+                            LowerBestScore(score);
+                        }
+                    }
+                }
+            });
+        }
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+        double us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+        // Ties go to the first candidate drawn, whichever thread drew it.
+        const RoundBest *round_best = nullptr;
+        uint64_t rejected = 0;
+        for (const RoundBest &b : bests) {
+            rejected += b.rejected;
+            if ((b.score != kRejected) && (!round_best || (b.score < round_best->score)
+                    || ((b.score == round_best->score) && (b.index < round_best->index)))) {
+                round_best = &b;
+            }
+        }
+
+        printf("round %u: %u candidates, %llu rejected, %.1f us each on %u threads\n",
+               round, candidates, (unsigned long long)rejected, us * threads / candidates, threads);
+
+        // A round which finds nothing better leaves the search where it was.
+        if (round_best && (round_best->score < best_score)) {
+            best = round_best->candidate;
+            best_score = round_best->score;
+            radius = (radius >= 1) ? kRoundShrink : (radius * kRoundShrink);
+            PrintCandidate(best, best_score, plays, target);
+        }
+    }
+
+    if (best_score == kRejected) {
+        fprintf(stderr, "No candidate reached level %u within %u skill uses with at most %u perks.\n",
+                target.level, target.uses * kMaxUsesRatio, target.maxPerks);
+        return EXIT_FAILURE;
+    }
+
+    WriteTestFile(path, CandidateIni(best, target));
+    if (!Verify(path, best, best_score, plays, target)) {
+        return EXIT_FAILURE;
+    }
+
+    printf("Wrote %s.\n", path.c_str());
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,267 @@
+/**
+ * @file FormulaTest.cpp
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Checks the parsing, folding and evaluation of INI formulas, and the
+ *        columns which errors are reported at.
+ * @bug No known bugs.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "Settings.h"
+#include "Formula.h"
+
+/// @brief The deepest a formula may nest, which matches Formula::kMaxDepth.
+static const unsigned int kMaxNesting = 32;
+
+/// @brief A valid formula, and its value at two levels.
+struct ValidCase {
+    const char *text;
+    double level0;
+    double level10;
+};
+
+/// @brief An invalid formula, and the position the error is reported at.
+struct InvalidCase {
+    const char *text;
+    size_t error;
+};
+
+/// @brief A formula, and the number of instructions it compiles to.
+struct FoldCase {
+    const char *text;
+    size_t size;
+};
+
+static const ValidCase kValid[] = {
+    { "1", 1, 1 },
+    { "level", 0, 10 },
+    { " \tlevel\t ", 0, 10 },
+    { "LEVEL * 2", 0, 20 },
+    { "1 + 2 * 3", 7, 7 },
+    { "(1 + 2) * 3", 9, 9 },
+    { "10 - 4 - 3", 3, 3 },
+    { "64 / 4 / 2", 8, 8 },
+    { "2 ^ 3 ^ 2", 512, 512 },
+    { "-2 ^ 2", -4, -4 },
+    { "2 ^ -1", 0.5, 0.5 },
+    { "--level", 0, 10 },
+    { "+-+level", 0, -10 },
+    { "level * -level", 0, -100 },
+    { "0x10 + 1.5e1 + .5", 31.5, 31.5 },
+    { "min(level, 5) + max(level, 5)", 5, 15 },
+    { "pow(level, 2) - sqrt(level * 10)", 0, 90 },
+    { "floor(level / 3) + ceil(level / 3)", 0, 7 },
+    { "log(exp(level))", 0, 10 },
+    { "Max(1, MIN(level, 2))", 1, 2 },
+    { "max( level , ( 3 ) )", 3, 10 },
+    { "1 + 0.25 * level ^ 1.5", 1, 1 + 0.25 * std::pow(10.0, 1.5) }
+};
+
+static const InvalidCase kInvalid[] = {
+    { "", 0 },
+    { "   ", 3 },
+    { "level +", 7 },
+    { "* level", 0 },
+    { "2 ** 3", 3 },
+    { "2 * (level", 10 },
+    { "(level))", 7 },
+    { "level level", 6 },
+    { "levels", 0 },
+    { "foo(1)", 0 },
+    { "min(1)", 5 },
+    { "min(1, 2, 3)", 8 },
+    { "min(1,)", 6 },
+    { "sqrt 4", 5 },
+    { "sqrt()", 5 },
+    { "1e", 1 },
+    { "1e999", 0 },
+    { "level + 1e999", 8 },
+    { "level % 2", 6 },
+    { "level = 2", 6 }
+};
+
+static const FoldCase kFolds[] = {
+    { "1 + 2 * 3", 1 },
+    { "-(2 ^ 3)", 1 },
+    { "sqrt(16) + min(1, 2)", 1 },
+    { "2 * 3 + level", 3 },
+    { "level * (1 + 2)", 3 },
+    { "-level", 2 },
+    { "max(level, 5 * 2)", 3 },
+    { "level + 1 + 2", 5 },
+    { "1 / 0", 1 }
+};
+
+/// @brief The number of checks which have failed.
+static unsigned int failures = 0;
+
+/**
+ * @brief Checks if two results of a formula are the same, to within rounding.
+ */
+static bool
+Same(
+    double a,
+    double b
+) {
+    return std::fabs(a - b) <= 1e-9 * std::fmax(1.0, std::fabs(b));
+}
+
+/**
+ * @brief Records a failed check.
+ */
+static void
+Check(
+    bool ok,
+    const char *what,
+    const std::string &text
+) {
+    if (!ok) {
+        printf("failed: %s \"%s\"\n", what, text.c_str());
+        failures++;
+    }
+}
+
+/**
+ * @brief Checks that a formula parses or fails at the given nesting depth.
+ */
+static void
+CheckNesting(
+    const char *what,
+    const std::string &open,
+    const std::string &middle,
+    const std::string &close,
+    unsigned int depth,
+    bool valid
+) {
+    std::string text;
+    for (unsigned int i = 0; i < depth; i++) {
+        text += open;
+    }
+    text += middle;
+    for (unsigned int i = 0; i < depth; i++) {
+        text += close;
+    }
+
+    Formula f;
+    size_t error = 0;
+    bool parsed = f.Parse(text, error);
+    Check(parsed == valid, what, text);
+    Check(parsed || f.Empty(), "left a program after failing", text);
+}
+
+int
+main() {
+    for (const ValidCase &c : kValid) {
+        Formula f;
+        size_t error = 0;
+        if (!f.Parse(c.text, error)) {
+            Check(false, "parse", c.text);
+            continue;
+        }
+
+        Check(Same(f.Eval(0), c.level0), "value at level 0", c.text);
+        Check(Same(f.Eval(10), c.level10), "value at level 10", c.text);
+    }
+
+    for (const InvalidCase &c : kInvalid) {
+        Formula f;
+        size_t error = SIZE_MAX;
+        Check(!f.Parse(c.text, error), "reject", c.text);
+        Check(error == c.error, "error column", c.text);
+        Check(f.Empty(), "left a program after failing", c.text);
+    }
+
+    // The parts of a formula which do not depend on the level are folded.
+    for (const FoldCase &c : kFolds) {
+        Formula f;
+        size_t error = 0;
+        Check(f.Parse(c.text, error) && (f.Size() == c.size), "fold", c.text);
+    }
+
+    // A failed parse leaves nothing of an earlier one.
+    {
+        Formula f;
+        size_t error = 0;
+        Check(f.Parse("level", error) && !f.Parse("level +", error) && f.Empty(),
+              "clear after failing", "level +");
+    }
+
+    // Expressions may nest as deep as the evaluation stack, and no deeper.
+    CheckNesting("parentheses", "(", "level", ")", kMaxNesting - 1, true);
+    CheckNesting("parentheses", "(", "level", ")", kMaxNesting, false);
+    CheckNesting("negation", "-", "level", "", kMaxNesting - 1, true);
+    CheckNesting("negation", "-", "level", "", kMaxNesting, false);
+    CheckNesting("calls", "min(level, ", "level", ")", kMaxNesting - 1, true);
+    CheckNesting("calls", "min(level, ", "level", ")", kMaxNesting, false);
+    CheckNesting("stack", "level + (", "level", ")", kMaxNesting - 1, true);
+    CheckNesting("stack", "level + (", "level", ")", kMaxNesting, false);
+    CheckNesting("constants", "1 + (", "1", ")", kMaxNesting - 1, true);
+    CheckNesting("constants", "1 + (", "1", ")", kMaxNesting, false);
+    CheckNesting("powers", "level ^ ", "level", "", kMaxNesting - 1, true);
+    CheckNesting("powers", "level ^ ", "level", "", kMaxNesting, false);
+
+    // A deep formula evaluates on a full stack.
+    {
+        std::string text;
+        for (unsigned int i = 0; i < kMaxNesting - 1; i++) {
+            text += "level + (";
+        }
+        text += "level";
+        text.append(kMaxNesting - 1, ')');
+
+        Formula f;
+        size_t error = 0;
+        Check(f.Parse(text, error) && Same(f.Eval(2), 2 * kMaxNesting), "deep value", text);
+    }
+
+    // Formulas may have no value at some levels, which the caller must check.
+    {
+        Formula f;
+        size_t error = 0;
+        Check(f.Parse("1 / 0", error) && std::isinf(f.Eval(0)), "infinite", "1 / 0");
+        Check(f.Parse("0 / 0", error) && std::isnan(f.Eval(0)), "not a number", "0 / 0");
+        Check(f.Parse("log(level)", error) && std::isinf(f.Eval(0)) && Same(f.Eval(1), 0),
+              "infinite at a level", "log(level)");
+        Check(f.Parse("sqrt(level - 5)", error) && std::isnan(f.Eval(4)) && Same(f.Eval(9), 2),
+              "not a number at a level", "sqrt(level - 5)");
+        Check(f.Parse("exp(level)", error) && std::isinf(f.Eval(1000)), "overflow", "exp(level)");
+    }
+
+    // The settings use the default at the levels a formula has no value.
+    {
+        LeveledArena arena;
+        LeveledSetting<float> list;
+        list.BeginRead(7.0f);
+        list.ReadEntry("Formula", "10 / (level - 5) + 0 * sqrt(level - 3)");
+        list.EndRead();
+        arena.Reset(list.ArenaSize());
+        list.Place(arena);
+        Check(list.Bind(arena), "bind", "formula list");
+
+        Check(list.Get(2) == 7.0f, "default where not a number", "level 2");
+        Check(list.Get(4) == -10.0f, "value between", "level 4");
+        Check(list.Get(5) == 7.0f, "default where infinite", "level 5");
+        Check(list.Get(15) == 1.0f, "value after", "level 15");
+    }
+
+    {
+        LeveledArena arena;
+        LeveledSetting<unsigned int> list;
+        list.BeginRead(3);
+        list.ReadEntry("Formula", "level * 1e300 * 1e300");
+        list.EndRead();
+        arena.Reset(list.ArenaSize());
+        list.Place(arena);
+        Check(list.Bind(arena), "bind", "overflowing formula list");
+
+        Check(list.Get(0) == 0, "value at 0", "level 0");
+        Check(list.Get(1) == 3, "default where infinite", "level 1");
+    }
+
+    printf("FormulaTest: %u failures.\n", failures);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,236 @@
+/**
+ * @file HookDriver.cpp
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Runs a scripted character progression through the real hooks against
+ *        the fake game, and reports the throughput and latency of each hook.
+ *
+ * Usage: HookDriver [ini path] [skill uses]
+ *
+ * The INI file is created with the default settings if it doesn't exist. Every
+ * patch must be enabled in it, as the fake game calls every hook.
+ *
+ * @bug No known bugs.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Settings.h"
+#include "Hook_Skill.h"
+#include "FakeGame.h"
+#include "Vanilla.h"
+
+/// @brief The number of hook calls timed together, so that the clock doesn't
+///        swamp the hook.
+static const unsigned int kBatchCalls = 256;
+
+/// @brief The number of batches timed for each hook.
+static const unsigned int kBatches = 4000;
+
+/// @brief How often the player opens the skills menu, in skill uses.
+static const unsigned int kMenuInterval = 64;
+
+/// @brief The skill level at which the player tries to make a skill legendary.
+static const float kLegendaryLevel = 100.0f;
+
+typedef std::chrono::steady_clock Clock;
+
+/// @brief The latency of a hook, in nanoseconds per call.
+struct HookLatency {
+    double p50;
+    double p99;
+    double max;
+};
+
+/// @brief Keeps the results of the timed hooks from being optimized out.
+static volatile float sink;
+
+/**
+ * @brief Gets the nanoseconds between two times.
+ */
+static double
+Nanoseconds(
+    Clock::time_point start,
+    Clock::time_point end
+) {
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+/**
+ * @brief Plays through a character, using skills at random with a fixed
+ *        preference for each.
+ * @param uses The number of skills to use.
+ * @param legendaries Returns the number of skills made legendary.
+ */
+static void
+RunProgression(
+    unsigned int uses,
+    unsigned int &legendaries
+) {
+    std::mt19937 rng(20240615);
+    std::uniform_real_distribution<float> pref_dist(0.1f, 1.0f);
+    std::uniform_real_distribution<float> action_dist(0.5f, 1.5f);
+
+    std::vector<float> prefs;
+    for (size_t i = 0; i < SkillSlot::kCount; i++) {
+        prefs.push_back(pref_dist(rng));
+    }
+    std::discrete_distribution<unsigned int> skill_dist(prefs.begin(), prefs.end());
+
+    static const ActorAttribute::t kChoices[] = {
+        ActorAttribute::Health,
+        ActorAttribute::Magicka,
+        ActorAttribute::Stamina
+    };
+
+    legendaries = 0;
+    for (unsigned int use = 0; use < uses; use++) {
+        SkillSlot::t slot = static_cast<SkillSlot::t>(skill_dist(rng));
+
+        // Every action reads the skill's formula level, and weapon hits also
+        // drain the charge of their enchantment.
+        sink = fakeGame.GetFormulaLevel(slot);
+        if (slot <= SkillSlot::Marksman) {
+            sink = fakeGame.GetChargePointsPerUse(50.0f, 1000.0f);
+        }
+
+        fakeGame.UseSkill(slot, VanillaActionExp(kVanillaSkills[slot]) * action_dist(rng));
+        while (fakeGame.CanLevelUp()) {
+            fakeGame.LevelUp(kChoices[fakeGame.GetLevel() % 3]);
+        }
+
+        // The button may be hidden, so the player tries to make any skill
+        // which has reached the vanilla legendary level legendary.
+        if ((use % kMenuInterval) == 0) {
+            for (size_t i = 0; i < SkillSlot::kCount; i++) {
+                SkillSlot::t menu_slot = static_cast<SkillSlot::t>(i);
+                sink = fakeGame.ShowsLegendaryButton(menu_slot);
+                if (fakeGame.GetBase(VanillaSkillAttribute(menu_slot)) >= kLegendaryLevel) {
+                    legendaries += fakeGame.MakeLegendary(menu_slot);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Times batches of calls to a hook, and gets its latency.
+ * @param call Calls the hook once, given the index of the call.
+ */
+static HookLatency
+TimeHook(
+    const std::function<void(unsigned int)> &call
+) {
+    std::vector<double> batches;
+    for (unsigned int b = 0; b < kBatches; b++) {
+        Clock::time_point start = Clock::now();
+        for (unsigned int i = 0; i < kBatchCalls; i++) {
+            call(i);
+        }
+        batches.push_back(Nanoseconds(start, Clock::now()) / kBatchCalls);
+    }
+
+    std::sort(batches.begin(), batches.end());
+    return {
+        batches[batches.size() / 2],
+        batches[(batches.size() * 99) / 100],
+        batches.back()
+    };
+}
+
+int
+main(
+    int argc,
+    char **argv
+) {
+    std::string path = (argc > 1) ? argv[1] : "build/HookDriver.ini";
+    unsigned int uses = (argc > 2) ? static_cast<unsigned int>(atoi(argv[2])) : 2000000;
+
+    if (!settings.ReadConfig(path)) {
+        fprintf(stderr, "Failed to load %s.\n", path.c_str());
+        return EXIT_FAILURE;
+    }
+
+    if (!settings.IsSkillCapEnabled() || !settings.IsSkillFormulaCapEnabled()
+            || !settings.IsEnchantPatchEnabled() || !settings.IsSkillExpEnabled()
+            || !settings.IsLevelExpEnabled() || !settings.IsPerkPointsEnabled()
+            || !settings.IsAttributePointsEnabled() || !settings.IsLegendaryEnabled()) {
+        fprintf(stderr, "Every patch must be enabled in %s.\n", path.c_str());
+        return EXIT_FAILURE;
+    }
+
+    unsigned int legendaries;
+    Clock::time_point start = Clock::now();
+    RunProgression(uses, legendaries);
+    double total_ns = Nanoseconds(start, Clock::now());
+
+    printf("Progression: %u skill uses in %.1f ms (%.2f M uses/s, %.1f ns/use)\n",
+           uses, total_ns / 1e6, uses / (total_ns / 1e3), total_ns / uses);
+    printf("Player level %u, %u perk points, %u skills made legendary\n\n",
+           fakeGame.GetLevel(), fakeGame.GetPerkPoints(), legendaries);
+
+    // Rotate through the skills, so that each call reads different settings.
+    std::vector<SkillSlot::t> slots;
+    std::mt19937 rng(20240616);
+    for (unsigned int i = 0; i < kBatchCalls; i++) {
+        slots.push_back(static_cast<SkillSlot::t>(rng() % SkillSlot::kCount));
+    }
+    auto attr = [&](unsigned int i) { return VanillaSkillAttribute(slots[i]); };
+
+    const FakeGame::HookCounts &counts = fakeGame.GetHookCounts();
+    struct {
+        const char *name;
+        uint64_t calls;
+        std::function<void(unsigned int)> call;
+    } hooks[] = {
+        { "GetSkillCap", counts.skillCap, [&](unsigned int i) {
+            sink = GetSkillCap_Hook(attr(i));
+        } },
+        { "CalculateChargePointsPerUse", counts.chargePoints, [&](unsigned int i) {
+            sink = CalculateChargePointsPerUse_Hook(&fakeGame, 50.0f, 1000.0f + i);
+        } },
+        { "PlayerAVOGetCurrent", counts.getCurrent, [&](unsigned int i) {
+            sink = PlayerAVOGetCurrent_Hook(&fakeGame, attr(i));
+        } },
+        { "ImprovePlayerSkillPoints", counts.improveSkill, [&](unsigned int i) {
+            ImprovePlayerSkillPoints_Hook(nullptr, attr(i), 1.0f, 0, 0, 0, false);
+        } },
+        { "ModifyPerkPool", counts.perkPool, [&](unsigned int i) {
+            sink = ModifyPerkPool_Hook(static_cast<UInt8>(i), 1);
+        } },
+        { "ImproveLevelExpBySkillLevel", counts.levelExp, [&](unsigned int i) {
+            sink = ImproveLevelExpBySkillLevel_Hook(50.0f, attr(i));
+        } },
+        { "ImproveAttributeWhenLevelUp", counts.attributes, [&](unsigned int) {
+            ImproveAttributeWhenLevelUp_Hook(&fakeGame, ActorAttribute::Stamina);
+        } },
+        { "LegendaryResetSkillLevel", counts.legendaryReset, [&](unsigned int i) {
+            LegendaryResetSkillLevel_Hook(100.0f + (i & 0x7F));
+        } },
+        { "CheckConditionForLegendarySkill", counts.legendaryCheck, [&](unsigned int i) {
+            sink = CheckConditionForLegendarySkill_Hook(&fakeGame, attr(i));
+        } },
+        { "HideLegendaryButton", counts.legendaryButton, [&](unsigned int i) {
+            sink = HideLegendaryButton_Hook(&fakeGame, attr(i));
+        } }
+    };
+
+    printf("%-32s %12s %10s %10s %10s\n", "hook", "calls", "p50 ns", "p99 ns", "max ns");
+    for (const auto &hook : hooks) {
+        HookLatency latency = TimeHook(hook.call);
+        printf("%-32s %12llu %10.1f %10.1f %10.1f\n",
+               hook.name,
+               static_cast<unsigned long long>(hook.calls),
+               latency.p50,
+               latency.p99,
+               latency.max);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,76 @@
+/**
+ * @file HookReplay.cpp
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Replays a hook trace recorded in the game through the hooks, under
+ *        the given settings, and reports every result which changed.
+ *
+ * Usage: HookReplay <trace path> [ini path]
+ *
+ * Record the trace by setting bEnableHookTrace in the game's INI file. Replay
+ * it under the same INI file to check a change to the code, or under another
+ * to see what a change to the settings does to a real session. Every patch
+ * must be enabled in the INI file.
+ *
+ * @bug No known bugs.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "Settings.h"
+#include "TraceReplay.h"
+
+/// @brief The most divergences to print.
+static const unsigned int kMaxReports = 20;
+
+int
+main(
+    int argc,
+    char **argv
+) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <trace path> [ini path]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::string path = (argc > 2) ? argv[2] : "build/SettingsBench.ini";
+    if (!settings.ReadConfig(path)) {
+        fprintf(stderr, "Failed to load %s.\n", path.c_str());
+        return EXIT_FAILURE;
+    }
+
+    if (!settings.IsSkillCapEnabled() || !settings.IsSkillFormulaCapEnabled()
+            || !settings.IsEnchantPatchEnabled() || !settings.IsSkillExpEnabled()
+            || !settings.IsLevelExpEnabled() || !settings.IsPerkPointsEnabled()
+            || !settings.IsAttributePointsEnabled() || !settings.IsLegendaryEnabled()) {
+        fprintf(stderr, "Every patch must be enabled in %s.\n", path.c_str());
+        return EXIT_FAILURE;
+    }
+
+    ReplayStats stats;
+    bool ok = ReplayTrace(argv[1], kMaxReports, stats);
+
+    uint64_t calls = 0, divergences = 0;
+    printf("%-32s %12s %12s %10s\n", "hook", "calls", "divergences", "mean ns");
+    for (unsigned int i = 0; i < HookTrace::kHookCount; i++) {
+        calls += stats.calls[i];
+        divergences += stats.divergences[i];
+        if (stats.calls[i]) {
+            printf("%-32s %12llu %12llu %10.1f\n",
+                   HookTrace::Str(static_cast<HookTrace::Hook>(i)),
+                   (unsigned long long)stats.calls[i],
+                   (unsigned long long)stats.divergences[i],
+                   stats.ns[i] / stats.calls[i]);
+        }
+    }
+
+    printf("\n%llu calls, %llu divergences, %llu dropped while recording.\n",
+           (unsigned long long)calls, (unsigned long long)divergences,
+           (unsigned long long)stats.dropped);
+    if (!ok) {
+        printf("The trace was cut short or corrupt.\n");
+    }
+
+    return (ok && !divergences) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,94 @@
+/**
+ * @file HookTest.cpp
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Checks that the hooks read the player's level and skills from the
+ *        game on every call, and give them to the settings unchanged.
+ * @bug No known bugs.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "Settings.h"
+#include "Hook_Skill.h"
+#include "FakeGame.h"
+#include "TestFiles.h"
+#include "Vanilla.h"
+
+/// @brief The number of checks which have failed.
+static unsigned int failures = 0;
+
+/**
+ * @brief Records a failed check.
+ */
+static void
+Check(
+    bool ok,
+    const char *what,
+    unsigned int arg
+) {
+    if (!ok && (failures++ < 20)) {
+        printf("failed: %s (%u)\n", what, arg);
+    }
+}
+
+int
+main() {
+    char ini[512];
+    sprintf_s(
+        ini,
+        "[General]\n"
+        "Version = %d\n"
+        "[PerksAtLevelUp]\n"
+        "0 = 1\n"
+        "10 = 3\n"
+        "[HealthAtLevelUp]\n"
+        "0 = 10\n"
+        "20 = 25\n"
+        "[LegendarySkill]\n"
+        "bHideLegendaryButton = false\n"
+        "iSkillLevelEnableLegendary = 100\n",
+        CONFIG_VERSION
+    );
+
+    std::string path = "build/HookTest.ini";
+    WriteTestFile(path, ini);
+    if (!settings.ReadConfig(path)) {
+        printf("HookTest: failed to load %s.\n", path.c_str());
+        return EXIT_FAILURE;
+    }
+
+    // The legendary hooks must check the skill's level, not its ID.
+    for (size_t i = 0; i < SkillSlot::kCount; i++) {
+        ActorAttribute::t attr = VanillaSkillAttribute(static_cast<SkillSlot::t>(i));
+
+        fakeGame.SetBase(attr, 99);
+        Check(!CheckConditionForLegendarySkill_Hook(&fakeGame, attr), "legendary at 99", attr);
+        Check(!HideLegendaryButton_Hook(&fakeGame, attr), "button at 99", attr);
+
+        fakeGame.SetBase(attr, 100);
+        Check(CheckConditionForLegendarySkill_Hook(&fakeGame, attr), "legendary at 100", attr);
+        Check(HideLegendaryButton_Hook(&fakeGame, attr), "button at 100", attr);
+    }
+
+    // Nothing may be remembered between calls, so going back a level must
+    // give back the gains of that level.
+    static const unsigned int kLevels[] = { 5, 10, 9, 19, 20, 11, 2 };
+    for (unsigned int level : kLevels) {
+        fakeGame.SetLevel(static_cast<UInt16>(level));
+        unsigned int perks = ModifyPerkPool_Hook(0, 1);
+        Check(perks == ((level >= 10) ? 3u : 1u), "perks at level", level);
+
+        float health = fakeGame.GetBase(ActorAttribute::Health);
+        ImproveAttributeWhenLevelUp_Hook(&fakeGame, ActorAttribute::Health);
+        float gain = fakeGame.GetBase(ActorAttribute::Health) - health;
+        Check(gain == ((level >= 20) ? 25.0f : 10.0f), "health at level", level);
+    }
+
+    // Losing points still goes through as it did.
+    Check(ModifyPerkPool_Hook(5, -2) == 3, "perk refund", 5);
+
+    printf("HookTest: %u failures.\n", failures);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,206 @@
+/**
+ * @file HookTraceTest.cpp
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Records a playthrough of the fake game, and checks that replaying the
+ *        trace gives back every result bit for bit, and only changes the
+ *        results a change to the settings should.
+ * @bug No known bugs.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Settings.h"
+#include "HookTrace.h"
+#include "FakeGame.h"
+#include "TestFiles.h"
+#include "TraceReplay.h"
+#include "Vanilla.h"
+
+/// @brief The number of skills the player uses.
+static const unsigned int kUses = 20000;
+
+/// @brief The number of threads which record at once, and the calls each
+///        makes. The calls fit in a thread's ring.
+static const unsigned int kThreads = 4;
+static const unsigned int kThreadCalls = 2000;
+
+/// @brief How often the recorded hooks are written out, in skill uses, so
+///        that no thread's ring fills up.
+static const unsigned int kFlushInterval = 64;
+
+/// @brief The paths the settings and trace are written to.
+static const char kIniPath[] = "build/HookTraceTest.ini";
+static const char kTracePath[] = "build/HookTraceTest.trace";
+
+/// @brief The number of checks which have failed.
+static unsigned int failures = 0;
+
+/**
+ * @brief Records a failed check.
+ */
+static void
+Check(
+    bool ok,
+    const char *what,
+    unsigned long long arg
+) {
+    if (!ok && (failures++ < 20)) {
+        printf("failed: %s (%llu)\n", what, arg);
+    }
+}
+
+/**
+ * @brief Loads settings which give the given number of perks from level 10.
+ */
+static bool
+LoadSettings(
+    unsigned int perks
+) {
+    char ini[512];
+    sprintf_s(
+        ini,
+        "[General]\n"
+        "Version = %d\n"
+        "[PerksAtLevelUp]\n"
+        "0 = 1\n"
+        "10 = %u\n"
+        "[HealthAtLevelUp]\n"
+        "0 = 10\n"
+        "20 = 25\n"
+        "[LegendarySkill]\n"
+        "bHideLegendaryButton = false\n"
+        "iSkillLevelEnableLegendary = 40\n",
+        CONFIG_VERSION,
+        perks
+    );
+
+    WriteTestFile(kIniPath, ini);
+    return settings.ReadConfig(kIniPath);
+}
+
+/**
+ * @brief Plays through a character, calling every hook.
+ */
+static void
+Play() {
+    static const ActorAttribute::t kChoices[] = {
+        ActorAttribute::Health,
+        ActorAttribute::Magicka,
+        ActorAttribute::Stamina
+    };
+
+    std::mt19937 rng(20240620);
+    std::uniform_real_distribution<float> exp_dist(0.5f, 20.0f);
+    fakeGame.Reset();
+    for (unsigned int i = 0; i < kUses; i++) {
+        SkillSlot::t slot = static_cast<SkillSlot::t>(rng() % SkillSlot::kCount);
+        fakeGame.UseSkill(slot, exp_dist(rng));
+        fakeGame.GetFormulaLevel(slot);
+        if ((i % 8) == 0) {
+            fakeGame.GetChargePointsPerUse(exp_dist(rng) * 50, 3000.0f);
+        }
+
+        while (fakeGame.CanLevelUp()) {
+            fakeGame.LevelUp(kChoices[rng() % 3]);
+        }
+
+        if (fakeGame.ShowsLegendaryButton(slot)) {
+            fakeGame.MakeLegendary(slot);
+        }
+
+        if ((i % kFlushInterval) == 0) {
+            hookTrace.Flush();
+        }
+    }
+}
+
+int
+main() {
+    if (!LoadSettings(2)) {
+        printf("HookTraceTest: failed to load %s.\n", kIniPath);
+        return EXIT_FAILURE;
+    }
+
+    Check(hookTrace.Start(kTracePath), "start", 0);
+    Play();
+    hookTrace.Stop();
+
+    // Every call must be in the trace, along with the game settings of each
+    // charge calculation.
+    const FakeGame::HookCounts &counts = fakeGame.GetHookCounts();
+    const uint64_t expected[HookTrace::kHookCount] = {
+        counts.skillCap,
+        counts.chargePoints,
+        counts.chargePoints,
+        counts.getCurrent,
+        counts.improveSkill,
+        counts.perkPool,
+        counts.levelExp,
+        counts.attributes,
+        counts.legendaryReset,
+        counts.legendaryCheck,
+        counts.legendaryButton
+    };
+
+    uint64_t records = 0;
+    ReplayStats stats;
+    Check(ReplayTrace(kTracePath, 5, stats), "replay", 0);
+    Check(stats.dropped == 0, "dropped records", stats.dropped);
+    for (unsigned int i = 0; i < HookTrace::kHookCount; i++) {
+        Check(expected[i] > 0, "hook never called", i);
+        Check(stats.calls[i] == expected[i], "calls in the trace", i);
+        Check(stats.divergences[i] == 0, "divergences", i);
+        records += stats.calls[i];
+    }
+
+    // Calls to a hook differ in few bytes, which the trace leaves out.
+    size_t size = ReadTestFile(kTracePath).size();
+    Check(size < (records * sizeof(HookTraceRecord)) / 2, "trace size", size);
+
+    // More perks from level 10 changes the perk hook, and only that.
+    if (!LoadSettings(3)) {
+        printf("HookTraceTest: failed to reload %s.\n", kIniPath);
+        return EXIT_FAILURE;
+    }
+
+    Check(ReplayTrace(kTracePath, 0, stats), "replay with new settings", 0);
+    for (unsigned int i = 0; i < HookTrace::kHookCount; i++) {
+        bool changed = (i == HookTrace::PerkPool);
+        Check((stats.divergences[i] > 0) == changed, "divergences with new settings", i);
+    }
+
+    // Each thread's calls are kept apart when several record at once.
+    Check(hookTrace.Start(kTracePath), "start threads", 0);
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < kThreads; i++) {
+        threads.emplace_back([]() {
+            for (unsigned int j = 0; j < kThreadCalls; j++) {
+                GetSkillCap_Hook(VanillaSkillAttribute(static_cast<SkillSlot::t>(j % SkillSlot::kCount)));
+            }
+        });
+    }
+
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    hookTrace.Stop();
+    Check(ReplayTrace(kTracePath, 5, stats), "replay threads", 0);
+    Check(stats.calls[HookTrace::SkillCap] == kThreads * kThreadCalls, "calls from threads",
+          stats.calls[HookTrace::SkillCap]);
+    Check(stats.divergences[HookTrace::SkillCap] == 0, "divergences from threads", 0);
+
+    // A trace cut short is reported.
+    std::string trace = ReadTestFile(kTracePath);
+    WriteTestFile(kTracePath, trace.substr(0, trace.size() - 3));
+    Check(!ReplayTrace(kTracePath, 0, stats) && stats.failed, "cut short", 0);
+
+    printf("HookTraceTest: %llu records in %zu bytes, %u failures.\n",
+           (unsigned long long)records, size, failures);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,229 @@
+/**
+ * @file IniTokenizerTest.cpp
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Checks the entries the INI tokenizer finds in files with unusual
+ *        layouts.
+ * @bug No known bugs.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "Ini.h"
+
+/// @brief A file, and the entries the tokenizer should find in it.
+struct TokenizerCase {
+    const char *name;
+    std::string text;
+
+    /// @brief The entries found without headers, one per line.
+    const char *entries;
+
+    /// @brief The entries found with headers, one per line.
+    const char *withHeaders;
+};
+
+/*
+ * Entries are written as section|key=value, and headers as [section].
+ */
+static const TokenizerCase kCases[] = {
+    {
+        "empty file",
+        "",
+        "",
+        ""
+    },
+    {
+        "byte order mark",
+        "\xEF\xBB\xBF[General]\r\nVersion = 7\r\n",
+        "General|Version=7\n",
+        "[General]\nGeneral|Version=7\n"
+    },
+    {
+        "only a byte order mark",
+        "\xEF\xBB\xBF",
+        "",
+        ""
+    },
+    {
+        "byte order mark before an entry",
+        "\xEF\xBB\xBFkey = 1",
+        "|key=1\n",
+        "|key=1\n"
+    },
+    {
+        "comments",
+        "; First\n# Second\n[A]\n  ; Indented\nx = 1 ; not a comment\n#y = 2\n",
+        "A|x=1 ; not a comment\n",
+        "[A]\nA|x=1 ; not a comment\n"
+    },
+    {
+        "entries before the first header",
+        "x = 1\n[A]\ny = 2\n",
+        "|x=1\nA|y=2\n",
+        "|x=1\n[A]\nA|y=2\n"
+    },
+    {
+        "unterminated headers",
+        "[A]\nx = 1\n[B\ny = 2\n[C]\nz = 3\n[D",
+        "A|x=1\nA|y=2\nC|z=3\n",
+        "[A]\nA|x=1\nA|y=2\n[C]\nC|z=3\n"
+    },
+    {
+        "header with a new line inside",
+        "[A\n]\nx = 1\n",
+        "|x=1\n",
+        "|x=1\n"
+    },
+    {
+        "header spacing and trailing text",
+        "  [  Spaced Name  ]  ignored = 1\nx = 1\n[]\ny = 2\n",
+        "Spaced Name|x=1\n|y=2\n",
+        "[Spaced Name]\nSpaced Name|x=1\n[]\n|y=2\n"
+    },
+    {
+        "empty keys",
+        "[A]\n= 1\n   = 2\nx = 3\n",
+        "A|x=3\n",
+        "[A]\nA|x=3\n"
+    },
+    {
+        "empty values",
+        "[A]\nx =\ny =   \nz=\n",
+        "A|x=\nA|y=\nA|z=\n",
+        "[A]\nA|x=\nA|y=\nA|z=\n"
+    },
+    {
+        "keys without values",
+        "[A]\njust a key\nx = 1\ntrailing key",
+        "A|x=1\n",
+        "[A]\nA|x=1\n"
+    },
+    {
+        "spacing around names and values",
+        "[A]\n\t x \t=\t 1 2 \t\r\n",
+        "A|x=1 2\n",
+        "[A]\nA|x=1 2\n"
+    },
+    {
+        "values with equals signs",
+        "[A]\nFormula = level = 2\n",
+        "A|Formula=level = 2\n",
+        "[A]\nA|Formula=level = 2\n"
+    },
+    {
+        "repeated headers",
+        "[A]\nx = 1\n[B]\ny = 2\n[A]\nz = 3\n",
+        "A|x=1\nB|y=2\nA|z=3\n",
+        "[A]\nA|x=1\n[B]\nB|y=2\n[A]\nA|z=3\n"
+    },
+    {
+        "CR line endings",
+        "[A]\rx = 1\ry = 2",
+        "A|x=1\nA|y=2\n",
+        "[A]\nA|x=1\nA|y=2\n"
+    },
+    {
+        "blank lines and no trailing new line",
+        "\r\n\r\n[A]\r\n\r\n\r\nx = 1",
+        "A|x=1\n",
+        "[A]\nA|x=1\n"
+    },
+    {
+        "embedded nul",
+        std::string("[A]\nx = 1\0 2\n", 13),
+        "A|x=1\\0 2\n",
+        "[A]\nA|x=1\\0 2\n"
+    }
+};
+
+/**
+ * @brief Appends a view to a listing, showing any nul characters.
+ */
+static void
+AppendView(
+    std::string &out,
+    std::string_view view
+) {
+    for (char c : view) {
+        if (c) {
+            out += c;
+        } else {
+            out += "\\0";
+        }
+    }
+}
+
+/**
+ * @brief Lists the entries the tokenizer finds in the given text.
+ */
+static std::string
+Tokenize(
+    const std::string &text,
+    bool headers
+) {
+    IniTokenizer tokenizer(text.data(), text.size(), headers);
+    std::string_view sec, key, value;
+    std::string out;
+    while (tokenizer.Next(sec, key, value)) {
+        if (key.empty()) {
+            out += "[";
+            AppendView(out, sec);
+            out += "]\n";
+            continue;
+        }
+
+        AppendView(out, sec);
+        out += "|";
+        AppendView(out, key);
+        out += "=";
+        AppendView(out, value);
+        out += "\n";
+    }
+
+    return out;
+}
+
+int
+main() {
+    unsigned int failures = 0;
+    for (const TokenizerCase &c : kCases) {
+        for (int headers = 0; headers < 2; headers++) {
+            std::string want = headers ? c.withHeaders : c.entries;
+            std::string got = Tokenize(c.text, headers != 0);
+            if (got != want) {
+                printf("failed: %s%s\nexpected:\n%sgot:\n%s",
+                       c.name, headers ? " with headers" : "", want.c_str(), got.c_str());
+                failures++;
+            }
+        }
+    }
+
+    // The entries under one header share its view, and a repeated header has
+    // a view of its own, so callers can tell when the header changes.
+    std::string text = "[A]\nx = 1\ny = 2\n[A]\nz = 3\n";
+    IniTokenizer tokenizer(text.data(), text.size());
+    std::string_view sec, key, value;
+    const char *header = nullptr;
+    unsigned int headers = 0;
+    while (tokenizer.Next(sec, key, value)) {
+        headers += (sec.data() != header);
+        header = sec.data();
+    }
+    if (headers != 2) {
+        printf("failed: repeated headers gave %u header changes\n", headers);
+        failures++;
+    }
+
+    // A header's value is empty, and sits at the end of its line.
+    text = "[A] trailing\nx = 1\n";
+    IniTokenizer with_headers(text.data(), text.size(), true);
+    if (!with_headers.Next(sec, key, value) || !value.empty() || (value.data() != text.data() + 12)) {
+        printf("failed: header value position\n");
+        failures++;
+    }
+
+    printf("IniTokenizerTest: %u failures.\n", failures);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
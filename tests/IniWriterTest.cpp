@@ -0,0 +1,183 @@
+/**
+ * @file IniWriterTest.cpp
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Checks the files the INI writer produces when updating existing files
+ *        with unusual layouts.
+ * @bug No known bugs.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "Ini.h"
+#include "TestFiles.h"
+
+/// @brief An entry written to a file.
+struct WriteOp {
+    const char *section;
+    const char *key;
+    const char *value;
+};
+
+/// @brief A file to update, the entries written to it, and the expected result.
+struct WriterCase {
+    const char *name;
+    const char *before;
+    std::vector<WriteOp> writes;
+    const char *after;
+};
+
+/// @brief The path the updated files are saved to.
+static const char kPath[] = "build/IniWriterTest.ini";
+
+static const WriterCase kCases[] = {
+    {
+        "replace and add without a trailing new line",
+        "[General]\r\niVersion = 6",
+        { { "General", "iVersion", "7" }, { "General", "bNew", "true" } },
+        "[General]\r\niVersion = 7\r\nbNew = true\r\n"
+    },
+    {
+        "add without a trailing new line",
+        "[General]\r\niVersion = 6",
+        { { "General", "bNew", "true" } },
+        "[General]\r\niVersion = 6\r\nbNew = true\r\n"
+    },
+    {
+        "replace the last value without a trailing new line",
+        "[General]\r\niVersion = 6",
+        { { "General", "iVersion", "7" } },
+        "[General]\r\niVersion = 7"
+    },
+    {
+        "replace and add with LF",
+        "[General]\niVersion = 6\n",
+        { { "General", "iVersion", "7" }, { "General", "bNew", "true" } },
+        "[General]\niVersion = 7\nbNew = true\n"
+    },
+    {
+        "replace and add with LF without a trailing new line",
+        "[General]\niVersion = 6",
+        { { "General", "iVersion", "7" }, { "General", "bNew", "true" } },
+        "[General]\niVersion = 7\nbNew = true\n"
+    },
+    {
+        "add to sections of CRLF and LF files",
+        "[A]\r\nx = 1\r\n[B]\r\ny = 2\r\n",
+        { { "A", "z", "3" }, { "B", "w", "4" } },
+        "[A]\r\nx = 1\r\nz = 3\r\n[B]\r\ny = 2\r\nw = 4\r\n"
+    },
+    {
+        "add to a header-only section at the end",
+        "[A]\nx = 1\n[B]",
+        { { "B", "y", "2" } },
+        "[A]\nx = 1\n[B]\ny = 2\n"
+    },
+    {
+        "add to a header-only section in the middle",
+        "[A]\n[B]\nx = 1\n",
+        { { "A", "y", "2" } },
+        "[A]\ny = 2\n[B]\nx = 1\n"
+    },
+    {
+        "add to several header-only sections",
+        "[A]\r\n[B]\r\n[C]",
+        { { "A", "x", "1" }, { "C", "z", "3" }, { "B", "y", "2" } },
+        "[A]\r\nx = 1\r\n[B]\r\ny = 2\r\n[C]\r\nz = 3\r\n"
+    },
+    {
+        "write to a duplicated section",
+        "[A]\nx = 1\n[B]\nz = 3\n[A]\ny = 2\n",
+        { { "A", "x", "5" }, { "A", "w", "4" } },
+        "[A]\nx = 5\n[B]\nz = 3\n[A]\ny = 2\nw = 4\n"
+    },
+    {
+        "replace a duplicated key",
+        "[A]\nx = 1\nx = 2\n",
+        { { "A", "x", "9" } },
+        "[A]\nx = 1\nx = 9\n"
+    },
+    {
+        "match names without case",
+        "[general]\r\nIVERSION = 6\r\n",
+        { { "General", "iVersion", "7" } },
+        "[general]\r\nIVERSION = 7\r\n"
+    },
+    {
+        "add a section without a trailing new line",
+        "[A]\nx = 1",
+        { { "B", "y", "2" } },
+        "[A]\nx = 1\n\n\n[B]\ny = 2\n"
+    },
+    {
+        "add a section and a key",
+        "[A]\r\nx = 1\r\n",
+        { { "B", "y", "2" }, { "A", "z", "3" }, { "B", "w", "4" } },
+        "[A]\r\nx = 1\r\nz = 3\r\n\r\n\r\n[B]\r\ny = 2\r\nw = 4\r\n"
+    },
+    {
+        "write to an empty file",
+        "",
+        { { "A", "x", "1" } },
+        "[A]\r\nx = 1\r\n"
+    }
+};
+
+/**
+ * @brief Prints a file with its line endings shown.
+ */
+static void
+PrintFile(
+    const char *label,
+    const std::string &text
+) {
+    printf("  %s: \"", label);
+    for (char c : text) {
+        if (c == '\r') {
+            printf("\\r");
+        } else if (c == '\n') {
+            printf("\\n");
+        } else {
+            putchar(c);
+        }
+    }
+    printf("\"\n");
+}
+
+int
+main() {
+    unsigned int failures = 0;
+    for (const WriterCase &c : kCases) {
+        std::string before(c.before);
+        IniWriter ini(before.data(), before.size());
+        for (const WriteOp &op : c.writes) {
+            ini.Write(op.section, op.key, op.value, nullptr);
+        }
+
+        bool saved = ini.Save(kPath);
+        std::string after = saved ? ReadTestFile(kPath) : std::string();
+        if (!saved || (after != c.after)) {
+            printf("failed: %s\n", c.name);
+            PrintFile("expected", c.after);
+            PrintFile("got", after);
+            failures++;
+        }
+    }
+
+    // A new file is written with CRLF line endings.
+    IniWriter fresh(64);
+    fresh.Write("A", "x", "1", nullptr);
+    fresh.Write("A", "y", "2", nullptr);
+    fresh.Write("B", "z", "3", "; A comment.\n; Over two lines.");
+    std::string expected = "[A]\r\nx = 1\r\ny = 2\r\n\r\n\r\n[B]\r\n\r\n"
+                           "; A comment.\r\n; Over two lines.\r\nz = 3\r\n";
+    if (!fresh.Save(kPath) || (ReadTestFile(kPath) != expected)) {
+        printf("failed: write a new file\n");
+        failures++;
+    }
+
+    printf("IniWriterTest: %u failures.\n", failures);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,146 @@
+/**
+ * @file LeveledSettingTest.cpp
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Checks the values of interpolated and formula lists, on both sides
+ *        of the end of their tables.
+ * @bug No known bugs.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Settings.h"
+
+/// @brief The first level past the table of an interpolated list.
+static const unsigned int kTableLevels = 4096;
+
+/// @brief The number of checks which have failed.
+static unsigned int failures = 0;
+
+/**
+ * @brief Records a failed check.
+ */
+static void
+Check(
+    bool ok,
+    const char *what,
+    unsigned int level
+) {
+    if (!ok && (failures++ < 20)) {
+        printf("failed: %s at level %u\n", what, level);
+    }
+}
+
+/**
+ * @brief A list read from INI entries, and placed in its own arena.
+ */
+template <typename T>
+struct TestList {
+    LeveledArena arena;
+    LeveledSetting<T> list;
+
+    TestList(
+        T def,
+        const std::vector<std::pair<std::string, std::string>> &entries
+    ) {
+        list.BeginRead(def);
+        for (const auto &entry : entries) {
+            list.ReadEntry(entry.first, entry.second);
+        }
+        list.EndRead();
+
+        arena.Reset(list.ArenaSize());
+        list.Place(arena);
+        bool bound = list.Bind(arena);
+        ASSERT(bound);
+    }
+};
+
+/**
+ * @brief Checks that a list which ends past its table gives the same values
+ *        as the same curve moved down into its table.
+ *
+ * The curves are flat up to their second entry, so moving them doesn't change
+ * their slopes.
+ */
+template <typename T>
+static void
+CheckShifted(
+    const char *mode,
+    const char *what
+) {
+    static const unsigned int kShift = 3000;
+    static const unsigned int kLevels[] = { 1000, 2000, 3000, 6000 };
+    static const char *kValues[] = { "10", "50", "55", "20" };
+
+    std::vector<std::pair<std::string, std::string>> high = { { "Interpolation", mode }, { "0", "10" } };
+    std::vector<std::pair<std::string, std::string>> low = high;
+    for (size_t i = 0; i < 4; i++) {
+        high.push_back({ std::to_string(kLevels[i] + kShift), kValues[i] });
+        low.push_back({ std::to_string(kLevels[i]), kValues[i] });
+    }
+
+    TestList<T> h(0, high), l(0, low);
+    for (unsigned int level = kLevels[0]; level <= kLevels[3] + 100; level++) {
+        Check(h.list.Get(level + kShift) == l.list.Get(level), what, level + kShift);
+    }
+}
+
+int
+main() {
+    // A linear list keeps blending its entries past the table.
+    {
+        TestList<float> t(0, { { "Interpolation", "Linear" }, { "0", "0" }, { "5000", "5000" } });
+        for (unsigned int level = 0; level <= 6000; level++) {
+            float want = static_cast<float>(MIN(level, 5000u));
+            Check(std::fabs(t.list.Get(level) - want) < 1e-3f, "linear", level);
+        }
+        Check(t.list.BlendEnd() == 5000, "linear blend end", 5000);
+    }
+
+    // Every entry past the table is still reached exactly.
+    {
+        TestList<unsigned int> t(1, {
+            { "Interpolation", "Cubic" }, { "4100", "7" }, { "4200", "300" }, { "9000", "2" }
+        });
+        Check(t.list.Get(4100) == 7, "entry", 4100);
+        Check(t.list.Get(4200) == 300, "entry", 4200);
+        Check(t.list.Get(9000) == 2, "entry", 9000);
+        Check(t.list.Get(100000) == 2, "after the last entry", 100000);
+
+        // The cubic curve stays within its entries between them.
+        for (unsigned int level = 4200; level < 9000; level++) {
+            unsigned int val = t.list.Get(level);
+            Check((val >= 2) && (val <= 300) && (val >= t.list.Get(level + 1)), "cubic", level);
+        }
+    }
+
+    CheckShifted<float>("Linear", "shifted linear");
+    CheckShifted<float>("Cubic", "shifted cubic");
+    CheckShifted<unsigned int>("Linear", "shifted whole linear");
+    CheckShifted<unsigned int>("Cubic", "shifted whole cubic");
+
+    // A step list steps, on both sides of where a table would end.
+    {
+        TestList<float> t(1, { { "0", "1" }, { "4000", "2" }, { "5000", "3" } });
+        Check(t.list.Get(4999) == 2.0f, "step", 4999);
+        Check(t.list.Get(5000) == 3.0f, "step", 5000);
+        Check(t.list.BlendEnd() == 0, "step blend end", 0);
+    }
+
+    // A formula list keeps the value of its last table level.
+    {
+        TestList<float> t(1, { { "Formula", "level / 2" } });
+        Check(t.list.Get(kTableLevels - 1) == (kTableLevels - 1) / 2.0f, "formula", kTableLevels - 1);
+        Check(t.list.Get(kTableLevels) == (kTableLevels - 1) / 2.0f, "formula", kTableLevels);
+        Check(t.list.Get(60000) == (kTableLevels - 1) / 2.0f, "formula", 60000);
+        Check(t.list.BlendEnd() == kTableLevels, "formula blend end", kTableLevels);
+    }
+
+    printf("LeveledSettingTest: %u failures.\n", failures);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,287 @@
+/**
+ * @file PerkScheduleTest.cpp
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Checks the compiled perk schedule against the per-level scan it
+ *        replaced, over thousands of random schedules.
+ * @bug No known bugs.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Settings.h"
+#include "PerkSchedule.h"
+
+/// @brief The highest level each schedule is checked up to.
+static const unsigned int kMaxCheckLevel = 7000;
+
+/// @brief The highest level a random schedule may have an entry at, which is
+///        past the dense table of the schedule.
+static const unsigned int kMaxEntryLevel = 6000;
+
+/// @brief The most entries a random schedule may have.
+static const unsigned int kMaxEntries = 40;
+
+/// @brief An entry of a perk schedule, as the old scan stored it.
+struct PerkEntry {
+    unsigned int level;
+    float item;
+
+    /// @brief The exact value of the entry, in millionths of a perk.
+    uint64_t micros;
+};
+
+/**
+ * @brief The perk delta as it was computed before the schedule was compiled,
+ *        by walking the whole list and summing in floats.
+ *
+ * The list must be sorted by level, and start at level 0.
+ */
+static unsigned int
+OldCumulativeDelta(
+    const std::vector<PerkEntry> &list,
+    unsigned int level
+) {
+    float pacc = 0, acc = 0;
+    for (size_t i = 0; (i < list.size()) && (list[i].level <= level); i++) {
+        // Update the accumulation. Note the exclusive upper bound on level.
+        unsigned int bound = ((i + 1) < list.size()) ? list[i + 1].level : level + 1;
+        unsigned int this_level = MIN(level + 1, bound);
+        acc += (this_level - list[i].level) * list[i].item;
+
+        // If this is the last iteration, get the previous accumulation.
+        if (((i + 1) >= list.size()) || (list[i + 1].level > level)) {
+            pacc = acc - list[i].item;
+        }
+    }
+
+    return static_cast<unsigned int>(acc) - static_cast<unsigned int>(pacc);
+}
+
+/**
+ * @brief Builds a random schedule, with values which are a whole number of
+ *        the given step.
+ *
+ * Level 0 is given the default of 1 about half of the time.
+ *
+ * @param rng The random source.
+ * @param step_micros The step, in millionths of a perk.
+ * @param max_steps The largest value, in steps.
+ */
+static std::vector<PerkEntry>
+RandomSchedule(
+    std::mt19937 &rng,
+    uint64_t step_micros,
+    unsigned int max_steps
+) {
+    std::uniform_int_distribution<unsigned int> count_dist(1, kMaxEntries);
+    std::uniform_int_distribution<unsigned int> level_dist(1, kMaxEntryLevel);
+    std::uniform_int_distribution<unsigned int> step_dist(0, max_steps);
+
+    std::vector<PerkEntry> list;
+    unsigned int count = count_dist(rng);
+    for (unsigned int i = 0; i < count; i++) {
+        unsigned int level = (i == 0) ? 0 : level_dist(rng);
+        uint64_t micros = ((i == 0) && (rng() & 1)) ? 1000000 : (step_dist(rng) * step_micros);
+        list.push_back({ level, static_cast<float>(micros / 1e6), micros });
+    }
+
+    // The first entry of a level is the one which is kept.
+    std::stable_sort(list.begin(), list.end(), [](const PerkEntry &a, const PerkEntry &b) {
+        return a.level < b.level;
+    });
+    list.erase(std::unique(list.begin(), list.end(), [](const PerkEntry &a, const PerkEntry &b) {
+        return a.level == b.level;
+    }), list.end());
+
+    return list;
+}
+
+/**
+ * @brief Compiles the given schedule the way the settings do, by reading it
+ *        into a leveled setting as INI entries.
+ *
+ * A level 0 entry of 1 is left out, so that the default fills it in.
+ */
+static void
+CompileSchedule(
+    const std::vector<PerkEntry> &list,
+    PerkSchedule &schedule
+) {
+    LeveledSetting<float> perks;
+    perks.BeginRead(1.0f);
+    for (const PerkEntry &entry : list) {
+        if ((entry.level == 0) && (entry.micros == 1000000)) {
+            continue;
+        }
+
+        char value[32];
+        sprintf_s(value, "%.6f", entry.micros / 1e6);
+        perks.ReadEntry(std::to_string(entry.level), value);
+    }
+    perks.EndRead();
+
+    LeveledArena arena;
+    arena.Reset(perks.ArenaSize());
+    perks.Place(arena);
+    bool bound = perks.Bind(arena);
+    ASSERT(bound);
+
+    schedule.Compile(perks);
+}
+
+/**
+ * @brief Gets the rate the schedule uses for a perk value, in millionths of a
+ *        perk.
+ */
+static uint64_t
+ExactRate(
+    float item
+) {
+    double val = item;
+    return (val > 0) ? static_cast<uint64_t>(MIN(256e6, val * 1e6 + 0.5)) : 0;
+}
+
+/**
+ * @brief Reads a random interpolated schedule, whose entries reach past the
+ *        dense table, into the given setting.
+ */
+static void
+RandomBlendedSchedule(
+    std::mt19937 &rng,
+    LeveledSetting<float> &perks,
+    LeveledArena &arena
+) {
+    std::uniform_int_distribution<unsigned int> count_dist(1, kMaxEntries);
+    std::uniform_int_distribution<unsigned int> level_dist(1, kMaxEntryLevel);
+    std::uniform_int_distribution<unsigned int> value_dist(0, 300);
+
+    perks.BeginRead(1.0f);
+    perks.ReadEntry("Interpolation", (rng() & 1) ? "Linear" : "Cubic");
+    unsigned int count = count_dist(rng);
+    for (unsigned int i = 0; i < count; i++) {
+        char value[32];
+        sprintf_s(value, "%.2f", value_dist(rng) / 100.0);
+        perks.ReadEntry(std::to_string(level_dist(rng)), value);
+    }
+    perks.EndRead();
+
+    arena.Reset(perks.ArenaSize());
+    perks.Place(arena);
+    bool bound = perks.Bind(arena);
+    ASSERT(bound);
+}
+
+/**
+ * @brief Gets the exact whole number of perks awarded up to each level.
+ */
+static std::vector<uint64_t>
+ExactTotals(
+    const std::vector<PerkEntry> &list
+) {
+    std::vector<uint64_t> totals;
+    uint64_t acc = 0;
+    size_t i = 0;
+    for (unsigned int level = 0; level <= kMaxCheckLevel; level++) {
+        while (((i + 1) < list.size()) && (list[i + 1].level <= level)) {
+            i++;
+        }
+
+        acc += list[i].micros;
+        totals.push_back(acc / 1000000);
+    }
+
+    return totals;
+}
+
+int
+main(
+    int argc,
+    char **argv
+) {
+    unsigned int runs = (argc > 1) ? static_cast<unsigned int>(atoi(argv[1])) : 2000;
+    std::mt19937 rng(20240607);
+    unsigned int failures = 0;
+
+    // Quarter perks add up exactly in a float, so both must agree everywhere.
+    for (unsigned int run = 0; run < runs; run++) {
+        std::vector<PerkEntry> list = RandomSchedule(rng, 250000, 16);
+        PerkSchedule schedule;
+        CompileSchedule(list, schedule);
+
+        for (unsigned int level = 1; level <= kMaxCheckLevel; level++) {
+            unsigned int want = OldCumulativeDelta(list, level);
+            unsigned int got = schedule.GetDelta(level);
+            if (want != got) {
+                if (failures++ < 10) {
+                    printf("quarter run %u: level %u gave %u, expected %u\n", run, level, got, want);
+                }
+                break;
+            }
+        }
+    }
+
+    // Decimal perks drift in a float, so the schedule is checked against the
+    // exact sum instead, and the old scan's drift is only counted.
+    unsigned int drifted = 0;
+    for (unsigned int run = 0; run < runs; run++) {
+        std::vector<PerkEntry> list = RandomSchedule(rng, 10000, 300);
+        PerkSchedule schedule;
+        CompileSchedule(list, schedule);
+
+        std::vector<uint64_t> totals = ExactTotals(list);
+        bool old_drifted = false;
+        for (unsigned int level = 1; level <= kMaxCheckLevel; level++) {
+            unsigned int want = static_cast<unsigned int>(totals[level] - totals[level - 1]);
+            unsigned int got = schedule.GetDelta(level);
+            if (want != got) {
+                if (failures++ < 10) {
+                    printf("decimal run %u: level %u gave %u, expected %u\n", run, level, got, want);
+                }
+                break;
+            }
+
+            old_drifted = old_drifted || (OldCumulativeDelta(list, level) != want);
+        }
+        drifted += old_drifted;
+    }
+
+    // Interpolated schedules give a different value at every level between
+    // their entries, past the dense table too, so they're summed level by
+    // level.
+    for (unsigned int run = 0; run < runs / 4; run++) {
+        LeveledArena arena;
+        LeveledSetting<float> perks;
+        RandomBlendedSchedule(rng, perks, arena);
+        PerkSchedule schedule;
+        schedule.Compile(perks);
+
+        uint64_t acc = ExactRate(perks.Get(0));
+        for (unsigned int level = 1; level <= kMaxCheckLevel; level++) {
+            uint64_t prev = acc / 1000000;
+            acc += ExactRate(perks.Get(level));
+
+            unsigned int want = static_cast<unsigned int>(acc / 1000000 - prev);
+            unsigned int got = schedule.GetDelta(level);
+            if (want != got) {
+                if (failures++ < 10) {
+                    printf("blended run %u: level %u gave %u, expected %u\n", run, level, got, want);
+                }
+                break;
+            }
+        }
+    }
+
+    printf(
+        "PerkScheduleTest: %u schedules, %u failures. The old scan drifted on %u of %u decimal schedules.\n",
+        runs * 2 + runs / 4,
+        failures,
+        drifted,
+        runs
+    );
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
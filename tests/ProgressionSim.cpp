@@ -0,0 +1,139 @@
+/**
+ * @file ProgressionSim.cpp
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Simulates many playthroughs under an INI file, and prints the skill,
+ *        level and perk trajectories of each as CSV.
+ *
+ * Usage: ProgressionSim [ini path] [playthroughs] [skill uses] [threads] > out.csv
+ *
+ * The INI file is loaded through the real settings, and is created with the
+ * default settings if it doesn't exist. Skills and levels follow the vanilla
+ * formulas in Vanilla.h, with the settings applied the way the hooks apply
+ * them. Each playthrough favours its own random mix of skills and attributes,
+ * and half of them make capped skills legendary.
+ *
+ * A row is printed for every level up, and one more for the end of each
+ * playthrough. Playthroughs are spread over the given number of threads, and
+ * the output doesn't depend on how many are used.
+ *
+ * @bug No known bugs.
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Settings.h"
+#include "Progression.h"
+#include "Vanilla.h"
+
+/// @brief The seed of the first playthrough. Each one after it adds one.
+static const unsigned int kSeed = 20240618;
+
+/**
+ * @brief Appends the state of a character to the CSV output of a playthrough.
+ */
+static void
+AppendRow(
+    std::string &out,
+    unsigned int playthrough,
+    unsigned int use,
+    const Character &c
+) {
+    char buf[64];
+    sprintf_s(buf, "%u,%u,%u,%u", playthrough, use, c.level, c.perks);
+    out += buf;
+
+    sprintf_s(buf, ",%g,%g,%g,%g",
+              c.attributes.health,
+              c.attributes.magicka,
+              c.attributes.stamina,
+              c.attributes.carry_weight);
+    out += buf;
+
+    for (size_t i = 0; i < SkillSlot::kCount; i++) {
+        sprintf_s(buf, ",%g", c.skills[i]);
+        out += buf;
+    }
+    out += '\n';
+}
+
+/**
+ * @brief Plays through one character, and returns its rows of the CSV.
+ */
+static std::string
+Simulate(
+    unsigned int playthrough,
+    unsigned int uses
+) {
+    std::mt19937 rng(kSeed + playthrough);
+    Playstyle style(rng, (playthrough & 1) != 0);
+
+    Character c;
+    StartCharacter(c);
+
+    std::string out;
+    AppendRow(out, playthrough, 0, c);
+    for (unsigned int use = 1; use <= uses; use++) {
+        SkillSlot::t slot = style.NextSkill(rng);
+        ImproveSkill(c, slot, style.NextExp(slot, rng), style.legendary, kNoExpScales);
+
+        while (c.levelExp >= VanillaLevelThreshold(c.level)) {
+            LevelUp(c, style.NextChoice(rng));
+            AppendRow(out, playthrough, use, c);
+        }
+    }
+
+    AppendRow(out, playthrough, uses, c);
+    return out;
+}
+
+int
+main(
+    int argc,
+    char **argv
+) {
+    std::string path = (argc > 1) ? argv[1] : "build/ProgressionSim.ini";
+    unsigned int playthroughs = (argc > 2) ? static_cast<unsigned int>(atoi(argv[2])) : 1000;
+    unsigned int uses = (argc > 3) ? static_cast<unsigned int>(atoi(argv[3])) : 100000;
+    unsigned int threads = (argc > 4)
+        ? static_cast<unsigned int>(atoi(argv[4]))
+        : std::thread::hardware_concurrency();
+    threads = (threads > 0) ? threads : 1;
+
+    if (!settings.ReadConfig(path)) {
+        fprintf(stderr, "Failed to load %s.\n", path.c_str());
+        return EXIT_FAILURE;
+    }
+
+    // The settings are only read from here on, so the threads can share them.
+    std::vector<std::string> rows(playthroughs);
+    std::atomic<unsigned int> next(0);
+    std::vector<std::thread> workers;
+    for (unsigned int t = 0; t < threads; t++) {
+        workers.emplace_back([&]() {
+            unsigned int p;
+            while ((p = next++) < playthroughs) {
+                rows[p] = Simulate(p, uses);
+            }
+        });
+    }
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+
+    printf("playthrough,use,level,perks,health,magicka,stamina,carry_weight");
+    for (size_t i = 0; i < SkillSlot::kCount; i++) {
+        printf(",%s", SkillSlot::Str(static_cast<SkillSlot::t>(i)));
+    }
+    printf("\n");
+
+    for (const std::string &row : rows) {
+        fwrite(row.data(), 1, row.size(), stdout);
+    }
+
+    return EXIT_SUCCESS;
+}
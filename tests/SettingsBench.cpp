@@ -0,0 +1,647 @@
+/**
+ * @file SettingsBench.cpp
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Measures the time, cache misses and allocations per call of every
+ *        settings query and hook, and of loading a large INI file, and prints
+ *        them as JSON.
+ *
+ * Usage: SettingsBench [ini path] > results.json
+ *
+ * The INI file is created with the default settings if it doesn't exist, and
+ * every patch must be enabled in it. Cache misses are read from the Linux perf
+ * counters, and are null where the counters can't be opened.
+ *
+ * The large INI file is the given one with many more levels in every leveled
+ * list. If the harness was built with SIMPLEINI set, loading it with SimpleIni
+ * is measured too.
+ *
+ * @bug No known bugs.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "Settings.h"
+#include "PerkSchedule.h"
+#include "Hook_Skill.h"
+#include "FakeGame.h"
+#include "Vanilla.h"
+#include "TestFiles.h"
+
+#ifdef HAVE_SIMPLEINI
+#include "SimpleIni.h"
+#endif
+
+/// @brief The number of distinct inputs each operation cycles through.
+static const unsigned int kInputCount = 4096;
+
+/// @brief The shortest time a measurement may run for, in nanoseconds.
+static const double kMinRunNs = 20e6;
+
+/// @brief The number of measurements taken of each operation. The fastest is
+///        reported.
+static const unsigned int kRepeats = 5;
+
+/// @brief The list sizes the leveled list and perk schedule are measured at.
+static const size_t kListSizes[] = { 1, 10, 100, 1000, 10000 };
+
+/// @brief The list sizes which building a leveled list is measured at.
+static const size_t kBuildSizes[] = { 1000, 10000, 100000 };
+
+/// @brief The number of levels added to each leveled list of the large INI.
+static const unsigned int kLargeListLevels = 1000;
+
+/// @brief The path the large INI file is written to.
+static const char kLargePath[] = "build/SettingsBenchLarge.ini";
+
+typedef std::chrono::steady_clock Clock;
+
+/// @brief Keeps the results of the measured operations from being optimized
+///        out.
+static volatile float sink;
+
+/// @brief The number of allocations made so far. The benchmark is single
+///        threaded, so this needs no lock.
+static uint64_t allocations = 0;
+
+void *
+operator new(
+    size_t size
+) {
+    allocations++;
+    void *p = malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+
+    return p;
+}
+
+void
+operator delete(
+    void *p
+) noexcept {
+    free(p);
+}
+
+void
+operator delete(
+    void *p,
+    size_t size
+) noexcept {
+    (void)size;
+    free(p);
+}
+
+/**
+ * @brief Counts the cache misses of this thread, if the kernel allows it.
+ */
+class CacheMissCounter {
+  private:
+    int fd;
+
+  public:
+    CacheMissCounter() {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    ~CacheMissCounter() {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    CacheMissCounter(const CacheMissCounter &) = delete;
+    CacheMissCounter &operator=(const CacheMissCounter &) = delete;
+
+    /// @brief Checks if the counter could be opened.
+    inline bool Valid(void) const { return fd >= 0; }
+
+    /// @brief Zeroes the counter and starts counting.
+    void
+    Start() {
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    /// @brief Stops counting, and gets the number of misses since Start().
+    uint64_t
+    Stop() {
+        uint64_t count = 0;
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fd, &count, sizeof(count)) != sizeof(count)) {
+                count = 0;
+            }
+        }
+
+        return count;
+    }
+};
+
+/// @brief A leveled list and perk schedule compiled from the same entries.
+struct ListFixture {
+    LeveledArena arena;
+    LeveledSetting<float> list;
+    PerkSchedule schedule;
+
+    /// @brief The last level with an entry in the list.
+    unsigned int lastLevel;
+};
+
+/**
+ * @brief Builds a leveled list and perk schedule with the given number of
+ *        entries, spread out over the levels.
+ */
+static std::unique_ptr<ListFixture>
+MakeList(
+    size_t size,
+    std::mt19937 &rng
+) {
+    std::uniform_int_distribution<unsigned int> gap_dist(1, 5);
+    std::uniform_int_distribution<unsigned int> value_dist(0, 8);
+
+    std::unique_ptr<ListFixture> fixture(new ListFixture());
+    fixture->list.BeginRead(1.0f);
+
+    unsigned int level = 0;
+    for (size_t i = 0; i < size; i++) {
+        char value[32];
+        sprintf_s(value, "%.2f", value_dist(rng) * 0.25);
+        fixture->list.ReadEntry(std::to_string(level), value);
+        fixture->lastLevel = level;
+        level += gap_dist(rng);
+    }
+    fixture->list.EndRead();
+
+    fixture->arena.Reset(fixture->list.ArenaSize());
+    fixture->list.Place(fixture->arena);
+    bool bound = fixture->list.Bind(fixture->arena);
+    ASSERT(bound);
+
+    fixture->schedule.Compile(fixture->list);
+    return fixture;
+}
+
+/// @brief The orders a list's levels may be looked up in.
+enum class LevelPattern {
+    /// @brief Any level, with no order.
+    Uniform,
+
+    /// @brief Mostly a few levels, as when one skill is used over and over.
+    Skewed,
+
+    /// @brief Rising levels, as over a playthrough.
+    Sequential
+};
+
+/// @brief The names of the lookup orders, and the benchmarks they are run in.
+static const struct {
+    LevelPattern pattern;
+    const char *get;
+    const char *getDelta;
+} kPatterns[] = {
+    { LevelPattern::Uniform, "LeveledSetting::Get", "PerkSchedule::GetDelta" },
+    { LevelPattern::Skewed, "LeveledSetting::Get (skewed)", "PerkSchedule::GetDelta (skewed)" },
+    { LevelPattern::Sequential, "LeveledSetting::Get (sequential)", "PerkSchedule::GetDelta (sequential)" }
+};
+
+/**
+ * @brief Picks the levels a list is looked up at, in the given order.
+ *
+ * Skewed lookups pick one of 16 levels nine times in ten. Sequential lookups
+ * climb through the list a few levels at a time, and start over at its end.
+ */
+static std::vector<unsigned int>
+MakeLevels(
+    LevelPattern pattern,
+    unsigned int lastLevel,
+    std::mt19937 &rng
+) {
+    std::uniform_int_distribution<unsigned int> level_dist(1, lastLevel + 10);
+    std::vector<unsigned int> hot;
+    for (unsigned int i = 0; i < 16; i++) {
+        hot.push_back(level_dist(rng));
+    }
+
+    unsigned int step = MAX(1u, (lastLevel + 10) / kInputCount);
+    std::vector<unsigned int> levels;
+    for (unsigned int i = 0; i < kInputCount; i++) {
+        switch (pattern) {
+            case LevelPattern::Uniform:
+                levels.push_back(level_dist(rng));
+                break;
+            case LevelPattern::Skewed:
+                levels.push_back(((rng() % 10) < 9) ? hot[rng() % hot.size()] : level_dist(rng));
+                break;
+            case LevelPattern::Sequential:
+                levels.push_back(1 + ((i * step) % (lastLevel + 10)));
+                break;
+        }
+    }
+
+    return levels;
+}
+
+/**
+ * @brief A leveled list as it was built before the entries were sorted once
+ *        at the end, by inserting each entry at its place in a sorted list.
+ *
+ * Building a list from n entries in no particular order moves O(n^2) entries.
+ */
+struct OldLeveledList {
+    struct LevelItem {
+        unsigned int level;
+        float item;
+    };
+
+    std::vector<LevelItem> list;
+
+    /// @brief Adds an item, unless its level is already in the list.
+    void
+    Add(
+        unsigned int level,
+        float item
+    ) {
+        size_t lo = 0, hi = list.size();
+        size_t mid = lo + ((hi - lo) >> 1);
+        while (lo < hi) {
+            if (level < list[mid].level) {
+                hi = mid;
+            } else if (level > list[mid].level) {
+                lo = mid + 1;
+            } else {
+                return;
+            }
+
+            mid = lo + ((hi - lo) >> 1);
+        }
+
+        list.insert(list.begin() + hi, { level, item });
+    }
+};
+
+/// @brief The result of measuring an operation.
+struct BenchResult {
+    double nsPerOp;
+    double missesPerOp;
+    double allocsPerOp;
+    uint64_t iterations;
+};
+
+/**
+ * @brief Measures an operation, which is called with each input index in turn.
+ *
+ * The number of calls is doubled until a run takes long enough, and then the
+ * fastest of several runs of that many calls is kept.
+ *
+ * @param iterations The number of calls to start from.
+ */
+static BenchResult
+Measure(
+    CacheMissCounter &counter,
+    const std::function<void(unsigned int)> &op,
+    uint64_t iterations
+) {
+    while (true) {
+        Clock::time_point start = Clock::now();
+        for (uint64_t i = 0; i < iterations; i++) {
+            op(static_cast<unsigned int>(i % kInputCount));
+        }
+
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        if (ns >= kMinRunNs) {
+            break;
+        }
+        iterations *= 2;
+    }
+
+    BenchResult best = { 0, 0, 0, iterations };
+    for (unsigned int r = 0; r < kRepeats; r++) {
+        uint64_t allocs = allocations;
+        counter.Start();
+        Clock::time_point start = Clock::now();
+        for (uint64_t i = 0; i < iterations; i++) {
+            op(static_cast<unsigned int>(i % kInputCount));
+        }
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        uint64_t misses = counter.Stop();
+        allocs = allocations - allocs;
+
+        if ((r == 0) || ((ns / iterations) < best.nsPerOp)) {
+            best.nsPerOp = ns / iterations;
+            best.missesPerOp = static_cast<double>(misses) / iterations;
+            best.allocsPerOp = static_cast<double>(allocs) / iterations;
+        }
+    }
+
+    return best;
+}
+
+/**
+ * @brief Prints the result of an operation as a JSON object.
+ * @param size The list size the operation was measured at, or 0 if it has
+ *             none.
+ */
+static void
+PrintResult(
+    bool first,
+    const char *name,
+    size_t size,
+    const BenchResult &result,
+    bool has_misses
+) {
+    printf("%s\n    { \"name\": \"%s\", ", first ? "" : ",", name);
+    if (size) {
+        printf("\"size\": %zu, ", size);
+    }
+    printf("\"ns_per_op\": %.3f, \"cache_misses_per_op\": ", result.nsPerOp);
+    if (has_misses) {
+        printf("%.5f", result.missesPerOp);
+    } else {
+        printf("null");
+    }
+    printf(", \"allocs_per_op\": %.3f, \"iterations\": %llu }",
+           result.allocsPerOp,
+           static_cast<unsigned long long>(result.iterations));
+}
+
+/**
+ * @brief Writes a copy of an INI file with many more levels in each of its
+ *        leveled lists.
+ *
+ * A section is taken to be a leveled list if it has a key which is a level.
+ * The new levels are written right after the header of each list, so the
+ * file reads as if the player wrote them.
+ *
+ * @return The number of entries in the new file.
+ */
+static size_t
+MakeLargeIni(
+    const std::string &from,
+    const std::string &to,
+    std::mt19937 &rng
+) {
+    std::string text = ReadTestFile(from);
+
+    std::unordered_set<std::string> lists;
+    size_t entries = 0;
+    {
+        IniTokenizer tokens(text.data(), text.size());
+        std::string_view sec, key, value;
+        while (tokens.Next(sec, key, value)) {
+            entries++;
+            if ((key[0] >= '0') && (key[0] <= '9') && (key.find(',') == std::string_view::npos)) {
+                lists.insert(std::string(sec));
+            }
+        }
+    }
+
+    std::string out;
+    std::uniform_int_distribution<unsigned int> gap_dist(1, 3);
+    std::uniform_int_distribution<unsigned int> value_dist(0, 20);
+    IniTokenizer headers(text.data(), text.size(), true);
+    std::string_view sec, key, value;
+    size_t copied = 0;
+    while (headers.Next(sec, key, value)) {
+        if (!key.empty() || !lists.count(std::string(sec))) {
+            continue;
+        }
+
+        // The header's value sits at the end of its line.
+        size_t eol = value.data() - text.data();
+        eol += ((eol < text.size()) && (text[eol] == '\r'));
+        eol += ((eol < text.size()) && (text[eol] == '\n'));
+        out.append(text, copied, eol - copied);
+        copied = eol;
+
+        unsigned int level = 0;
+        for (unsigned int i = 0; i < kLargeListLevels; i++) {
+            level += gap_dist(rng);
+            out += std::to_string(level) + " = " + std::to_string(value_dist(rng)) + "\r\n";
+        }
+        entries += kLargeListLevels;
+    }
+    out.append(text, copied, std::string::npos);
+
+    WriteTestFile(to, out);
+    return entries;
+}
+
+int
+main(
+    int argc,
+    char **argv
+) {
+    std::string path = (argc > 1) ? argv[1] : "build/SettingsBench.ini";
+    if (!settings.ReadConfig(path)) {
+        fprintf(stderr, "Failed to load %s.\n", path.c_str());
+        return EXIT_FAILURE;
+    }
+
+    if (!settings.IsSkillCapEnabled() || !settings.IsSkillFormulaCapEnabled()
+            || !settings.IsEnchantPatchEnabled() || !settings.IsSkillExpEnabled()
+            || !settings.IsLevelExpEnabled() || !settings.IsPerkPointsEnabled()
+            || !settings.IsAttributePointsEnabled() || !settings.IsLegendaryEnabled()) {
+        fprintf(stderr, "Every patch must be enabled in %s.\n", path.c_str());
+        return EXIT_FAILURE;
+    }
+
+    CacheMissCounter counter;
+    std::mt19937 rng(20240617);
+
+    // Random skills and levels, as the hooks would see over a playthrough.
+    std::vector<ActorAttribute::t> skills;
+    std::vector<unsigned int> skill_levels, player_levels;
+    std::vector<ActorAttribute::t> choices;
+    static const ActorAttribute::t kChoices[] = {
+        ActorAttribute::Health,
+        ActorAttribute::Magicka,
+        ActorAttribute::Stamina
+    };
+    for (unsigned int i = 0; i < kInputCount; i++) {
+        skills.push_back(VanillaSkillAttribute(static_cast<SkillSlot::t>(rng() % SkillSlot::kCount)));
+        skill_levels.push_back(15 + (rng() % 286));
+        player_levels.push_back(1 + (rng() % 300));
+        choices.push_back(kChoices[rng() % 3]);
+    }
+
+    printf("{\n  \"benchmarks\": [");
+    bool first = true;
+    auto run = [&](const char *name, size_t size, const std::function<void(unsigned int)> &op) {
+        PrintResult(first, name, size, Measure(counter, op, kInputCount), counter.Valid());
+        first = false;
+    };
+
+    for (size_t size : kListSizes) {
+        std::unique_ptr<ListFixture> fixture = MakeList(size, rng);
+        for (const auto &p : kPatterns) {
+            std::vector<unsigned int> levels = MakeLevels(p.pattern, fixture->lastLevel, rng);
+            run(p.get, size, [&](unsigned int i) {
+                sink = fixture->list.Get(levels[i]);
+            });
+            run(p.getDelta, size, [&](unsigned int i) {
+                sink = static_cast<float>(fixture->schedule.GetDelta(levels[i]));
+            });
+        }
+    }
+
+    // Building a list parses its entries as they were read from the file, in
+    // no particular order. The old list parses them the same way, so only
+    // the way the entries are stored differs.
+    for (size_t size : kBuildSizes) {
+        std::vector<std::pair<std::string, std::string>> entries;
+        for (size_t i = 0; i < size; i++) {
+            entries.push_back({ std::to_string(i * 3), std::to_string((rng() % 9) * 0.25) });
+        }
+        std::shuffle(entries.begin(), entries.end(), rng);
+
+        auto build = [&](const char *name, const std::function<void(unsigned int)> &op) {
+            PrintResult(first, name, size, Measure(counter, op, 1), counter.Valid());
+            first = false;
+        };
+        build("LeveledSetting::ReadEntry+EndRead", [&](unsigned int) {
+            LeveledSetting<float> list;
+            list.BeginRead(1.0f);
+            for (const auto &entry : entries) {
+                list.ReadEntry(entry.first, entry.second);
+            }
+            list.EndRead();
+            sink = static_cast<float>(list.ArenaSize());
+        });
+        build("OldLeveledList::Add", [&](unsigned int) {
+            OldLeveledList list;
+            for (const auto &entry : entries) {
+                list.Add(ParseIniLevel(entry.first), ParseIniValue(entry.second, 1.0f));
+            }
+            list.Add(0, 1.0f);
+            sink = static_cast<float>(list.list.size());
+        });
+    }
+
+    run("Settings::GetSkillExpGainMult", 0, [&](unsigned int i) {
+        sink = settings.GetSkillExpGainMult(skills[i], skill_levels[i], player_levels[i]);
+    });
+    run("Settings::GetLevelSkillExpMult", 0, [&](unsigned int i) {
+        sink = settings.GetLevelSkillExpMult(skills[i], skill_levels[i], player_levels[i]);
+    });
+    run("Settings::GetAttributeLevelUp", 0, [&](unsigned int i) {
+        ActorAttributeLevelUp level_up;
+        settings.GetAttributeLevelUp(player_levels[i], choices[i], level_up);
+        sink = level_up.health;
+    });
+    run("Settings::GetPerkDelta", 0, [&](unsigned int i) {
+        sink = static_cast<float>(settings.GetPerkDelta(player_levels[i]));
+    });
+    run("Settings::GetPostLegendarySkillLevel", 0, [&](unsigned int i) {
+        sink = settings.GetPostLegendarySkillLevel(15.0f, static_cast<float>(skill_levels[i]));
+    });
+
+    run("GetSkillCap_Hook", 0, [&](unsigned int i) {
+        sink = GetSkillCap_Hook(skills[i]);
+    });
+    run("CalculateChargePointsPerUse_Hook", 0, [&](unsigned int i) {
+        sink = CalculateChargePointsPerUse_Hook(&fakeGame, 50.0f, 1000.0f + (i & 0xFF));
+    });
+    run("PlayerAVOGetCurrent_Hook", 0, [&](unsigned int i) {
+        sink = PlayerAVOGetCurrent_Hook(&fakeGame, skills[i]);
+    });
+    run("ImprovePlayerSkillPoints_Hook", 0, [&](unsigned int i) {
+        ImprovePlayerSkillPoints_Hook(nullptr, skills[i], 1.0f, 0, 0, 0, false);
+    });
+    run("ModifyPerkPool_Hook", 0, [&](unsigned int i) {
+        sink = ModifyPerkPool_Hook(static_cast<UInt8>(i), 1);
+    });
+    run("ImproveLevelExpBySkillLevel_Hook", 0, [&](unsigned int i) {
+        sink = ImproveLevelExpBySkillLevel_Hook(50.0f, skills[i]);
+    });
+    run("ImproveAttributeWhenLevelUp_Hook", 0, [&](unsigned int i) {
+        ImproveAttributeWhenLevelUp_Hook(&fakeGame, choices[i]);
+    });
+    run("LegendaryResetSkillLevel_Hook", 0, [&](unsigned int i) {
+        LegendaryResetSkillLevel_Hook(static_cast<float>(skill_levels[i]));
+    });
+    run("CheckConditionForLegendarySkill_Hook", 0, [&](unsigned int i) {
+        sink = CheckConditionForLegendarySkill_Hook(&fakeGame, skills[i]);
+    });
+    run("HideLegendaryButton_Hook", 0, [&](unsigned int i) {
+        sink = HideLegendaryButton_Hook(&fakeGame, skills[i]);
+    });
+
+    // Loads take milliseconds, so they start from a single call. These
+    // replace the loaded settings, so they come last.
+    size_t large_entries = MakeLargeIni(path, kLargePath, rng);
+    std::string large_cache = std::string(kLargePath) + ".cache";
+    auto run_load = [&](const char *name, const std::function<void(unsigned int)> &op) {
+        PrintResult(first, name, large_entries, Measure(counter, op, 1), counter.Valid());
+        first = false;
+    };
+
+    run_load("IniTokenizer::Next", [&](unsigned int) {
+        MappedFile file;
+        file.Open(kLargePath);
+        IniTokenizer tokens(file.Data(), file.Size());
+        std::string_view sec, key, value;
+        size_t n = 0;
+        while (tokens.Next(sec, key, value)) {
+            n++;
+        }
+        sink = static_cast<float>(n);
+    });
+    run_load("Settings::ReadConfig (uncached)", [&](unsigned int) {
+        remove(large_cache.c_str());
+        sink = settings.ReadConfig(kLargePath);
+    });
+    run_load("Settings::ReadConfig (cached)", [&](unsigned int) {
+        sink = settings.ReadConfig(kLargePath);
+    });
+
+#ifdef HAVE_SIMPLEINI
+    // The settings were read from SimpleIni by looking up every key of every
+    // section, before the tokenizer replaced it.
+    run_load("CSimpleIniA::LoadFile", [&](unsigned int) {
+        CSimpleIniA ini;
+        ini.LoadFile(kLargePath);
+
+        CSimpleIniA::TNamesDepend sections, keys;
+        ini.GetAllSections(sections);
+        size_t n = 0;
+        for (const CSimpleIniA::Entry &sec : sections) {
+            ini.GetAllKeys(sec.pItem, keys);
+            for (const CSimpleIniA::Entry &key : keys) {
+                n += (ini.GetValue(sec.pItem, key.pItem) != nullptr);
+            }
+        }
+        sink = static_cast<float>(n);
+    });
+#endif
+
+    printf("\n  ]\n}\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,138 @@
+/**
+ * @file SettingsStoreTest.cpp
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Checks that readers of the settings store always see a whole, live
+ *        snapshot while the INI file is reloaded under them.
+ *
+ * Build the tests with -fsanitize=address to also catch reads of freed
+ * snapshots.
+ *
+ * @bug No known bugs.
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Settings.h"
+#include "SettingsStore.h"
+#include "TestFiles.h"
+
+/// @brief The number of threads reading the settings during the reloads.
+static const unsigned int kReaders = 4;
+
+/// @brief The number of times the INI file is reloaded.
+static const unsigned int kReloads = 200;
+
+/// @brief The perks given at levels 1 and 30 by each of the INI files.
+static const unsigned int kPerks[2][2] = { { 1, 3 }, { 2, 4 } };
+
+/// @brief The path the INI files are written to.
+static const char kPath[] = "build/SettingsStoreTest.ini";
+
+/// @brief The number of checks which have failed.
+static std::atomic<unsigned int> failures(0);
+
+/**
+ * @brief Records a failed check.
+ */
+static void
+Check(
+    bool ok,
+    const char *what,
+    unsigned int arg
+) {
+    if (!ok && (failures++ < 20)) {
+        printf("failed: %s (%u)\n", what, arg);
+    }
+}
+
+/**
+ * @brief Writes the INI file with the perks of the given version.
+ */
+static void
+WriteIni(
+    unsigned int version
+) {
+    char ini[256];
+    sprintf_s(
+        ini,
+        "[General]\n"
+        "Version = %d\n"
+        "[PerksAtLevelUp]\n"
+        "0 = %u\n"
+        "20 = %u\n",
+        CONFIG_VERSION,
+        kPerks[version][0],
+        kPerks[version][1]
+    );
+    WriteTestFile(kPath, ini);
+}
+
+/**
+ * @brief Reads the settings until told to stop, checking that every read of a
+ *        snapshot comes from the same INI file.
+ * @param stop Set when the reloads are done.
+ * @param reads Counts the reads of each INI file's settings.
+ */
+static void
+ReadSettings(
+    const std::atomic<bool> &stop,
+    unsigned int *reads
+) {
+    while (!stop.load()) {
+        SettingsReader reader;
+        unsigned int low = reader->GetPerkDelta(1);
+
+        // Give the reloads a chance to free the snapshot under us.
+        std::this_thread::yield();
+
+        unsigned int high = reader->GetPerkDelta(30);
+        unsigned int version = (low == kPerks[1][0]) ? 1 : 0;
+        Check((low == kPerks[version][0]) && (high == kPerks[version][1]), "torn snapshot", low);
+        reads[version]++;
+    }
+}
+
+int
+main() {
+    WriteIni(0);
+    if (!settings.ReadConfig(kPath)) {
+        printf("SettingsStoreTest: failed to load %s.\n", kPath);
+        return EXIT_FAILURE;
+    }
+
+    Check(!settingsStore.IsWatching(), "watching before Watch()", 0);
+    Check(settingsStore.Watch(kPath) && settingsStore.IsWatching(), "watch", 0);
+
+    std::atomic<bool> stop(false);
+    std::vector<std::thread> threads;
+    unsigned int reads[kReaders][2] = {};
+    for (unsigned int i = 0; i < kReaders; i++) {
+        threads.emplace_back(ReadSettings, std::cref(stop), reads[i]);
+    }
+
+    for (unsigned int i = 1; i <= kReloads; i++) {
+        WriteIni(i & 1);
+        settingsStore.Reload();
+    }
+
+    stop = true;
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    // Every reader must have got through, and the last reload must stick.
+    for (unsigned int i = 0; i < kReaders; i++) {
+        Check(reads[i][0] + reads[i][1] > 0, "reader made no reads", i);
+    }
+
+    SettingsReader reader;
+    Check(reader->GetPerkDelta(1) == kPerks[kReloads & 1][0], "last reload", kReloads);
+
+    printf("SettingsStoreTest: %u failures.\n", failures.load());
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,295 @@
+/**
+ * @file FakeGame.cpp
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Implementation of the fake game, and of the game functions the
+ *        plugin calls.
+ * @bug No known bugs.
+ */
+
+#include "FakeGame.h"
+
+#include <cstring>
+
+#include "Hook_Skill.h"
+#include "HookWrappers.h"
+#include "RelocFn.h"
+#include "Vanilla.h"
+
+/// @brief The game the hooks run against.
+FakeGame fakeGame;
+
+/**
+ * @brief Creates a new character.
+ */
+FakeGame::FakeGame() {
+    Reset();
+}
+
+/**
+ * @brief Resets the game to a new level 1 character with the vanilla game
+ *        settings, and clears the hook counts.
+ */
+void
+FakeGame::Reset() {
+    for (size_t i = 0; i < kAttributeCount; i++) {
+        base[i] = 0;
+        modifier[i] = 0;
+    }
+
+    for (size_t i = 0; i < SkillSlot::kCount; i++) {
+        base[VanillaSkillAttribute(static_cast<SkillSlot::t>(i))] = kVanillaStartSkillLevel;
+        skillExp[i] = 0;
+    }
+
+    base[ActorAttribute::Health] = kVanillaStartAttribute;
+    base[ActorAttribute::Magicka] = kVanillaStartAttribute;
+    base[ActorAttribute::Stamina] = kVanillaStartAttribute;
+    base[ActorAttribute::CarryWeight] = kVanillaStartCarryWeight;
+
+    gameSettings.clear();
+    for (const VanillaGameSetting *s = kVanillaGameSettings; s->name; s++) {
+        gameSettings.push_back(s->value);
+    }
+
+    level = 1;
+    levelExp = 0;
+    perkPoints = 0;
+    passive = false;
+    passedExp = 0;
+    memset(&counts, 0, sizeof(counts));
+}
+
+/**
+ * @brief Gets the value of a float game setting, which the caller may modify.
+ *
+ * The game would return null for a setting it doesn't have. The fake game
+ * halts instead, so that a typo in a hook can't go unnoticed.
+ */
+float *
+FakeGame::GetFloatSetting(
+    const char *name
+) {
+    for (size_t i = 0; kVanillaGameSettings[i].name; i++) {
+        if (!strcmp(kVanillaGameSettings[i].name, name)) {
+            return &gameSettings[i];
+        }
+    }
+
+    HALT("Unknown game setting.");
+    return nullptr;
+}
+
+/**
+ * @brief Adds exp to a skill, raising its level as the game does.
+ *
+ * This is the original function which the skill exp hook calls into. Each
+ * level the skill gains gives the player level exp, which goes through the
+ * level exp hook, and the skill can't go past the cap from the skill cap hook.
+ *
+ * A passive game only remembers the exp it was given, so that the skill exp
+ * hook can be replayed on its own.
+ */
+void
+FakeGame::ImproveSkill(
+    ActorAttribute::t attr,
+    float exp
+) {
+    passedExp = exp;
+    if (passive) {
+        return;
+    }
+
+    counts.skillCap++;
+    float cap = GetSkillCap_Hook(attr);
+
+    SkillSlot::t slot = SkillSlot::FromAttribute(attr);
+    const VanillaSkill &skill = kVanillaSkills[slot];
+    skillExp[slot] += exp;
+    while (base[attr] < cap) {
+        float threshold = VanillaSkillThreshold(skill, base[attr]);
+        if (skillExp[slot] < threshold) {
+            break;
+        }
+
+        skillExp[slot] -= threshold;
+        base[attr] += 1;
+
+        counts.levelExp++;
+        levelExp += ImproveLevelExpBySkillLevel_Hook(
+            *GetFloatSetting("fXPPerSkillRank") * base[attr],
+            attr
+        );
+    }
+
+    // A capped skill can't bank exp towards its next level.
+    if (base[attr] >= cap) {
+        skillExp[slot] = 0;
+    }
+}
+
+/**
+ * @brief Uses a skill, giving it the given exp before multipliers.
+ */
+void
+FakeGame::UseSkill(
+    SkillSlot::t slot,
+    float exp
+) {
+    counts.improveSkill++;
+    ImprovePlayerSkillPoints_Hook(nullptr, VanillaSkillAttribute(slot), exp, 0, 0, 0, false);
+}
+
+/**
+ * @brief Gets the skill level the game uses in its formulas, such as for
+ *        damage or prices.
+ */
+float
+FakeGame::GetFormulaLevel(
+    SkillSlot::t slot
+) {
+    counts.getCurrent++;
+    return PlayerAVOGetCurrent_Hook(this, VanillaSkillAttribute(slot));
+}
+
+/**
+ * @brief Gets the charge an enchanted item uses per hit.
+ */
+float
+FakeGame::GetChargePointsPerUse(
+    float base_points,
+    float max_charge
+) {
+    counts.chargePoints++;
+    return CalculateChargePointsPerUse_Hook(this, base_points, max_charge);
+}
+
+/**
+ * @brief Checks if the player has enough level exp to level up.
+ */
+bool
+FakeGame::CanLevelUp() const {
+    return levelExp >= VanillaLevelThreshold(level);
+}
+
+/**
+ * @brief Levels up the player, who picked the given attribute.
+ *
+ * The player's level is raised before the perk and attribute hooks run, as
+ * the hooks look up the gains of the new level.
+ */
+void
+FakeGame::LevelUp(
+    ActorAttribute::t choice
+) {
+    ASSERT(CanLevelUp());
+    levelExp -= VanillaLevelThreshold(level);
+    level++;
+
+    counts.perkPool++;
+    perkPoints = ModifyPerkPool_Hook(perkPoints, 1);
+
+    counts.attributes++;
+    ImproveAttributeWhenLevelUp_Hook(this, choice);
+}
+
+/**
+ * @brief Checks if the skills menu would show the legendary button of a skill.
+ */
+bool
+FakeGame::ShowsLegendaryButton(
+    SkillSlot::t slot
+) {
+    counts.legendaryButton++;
+    return HideLegendaryButton_Hook(this, VanillaSkillAttribute(slot));
+}
+
+/**
+ * @brief Makes a skill legendary, if the game allows it.
+ * @return True if the skill was made legendary.
+ */
+bool
+FakeGame::MakeLegendary(
+    SkillSlot::t slot
+) {
+    ActorAttribute::t attr = VanillaSkillAttribute(slot);
+
+    counts.legendaryCheck++;
+    if (!CheckConditionForLegendarySkill_Hook(this, attr)) {
+        return false;
+    }
+
+    counts.legendaryReset++;
+    LegendaryResetSkillLevel_Hook(base[attr]);
+    base[attr] = *GetFloatSetting("fLegendarySkillResetValue");
+    skillExp[slot] = 0;
+    return true;
+}
+
+float *
+GetFloatGameSetting(
+    const char *var
+) {
+    return fakeGame.GetFloatSetting(var);
+}
+
+UInt16
+GetPlayerLevel() {
+    return fakeGame.GetLevel();
+}
+
+void *
+GetPlayerActorValueOwner() {
+    return &fakeGame;
+}
+
+float
+PlayerAVOGetBase(
+    ActorAttribute::t attr
+) {
+    return fakeGame.GetBase(attr);
+}
+
+float
+PlayerAVOGetCurrent_Original(
+    void *av,
+    ActorAttribute::t attr
+) {
+    (void)av;
+    return fakeGame.GetCurrent(attr);
+}
+
+void
+PlayerAVOModBase(
+    ActorAttribute::t attr,
+    float val
+) {
+    fakeGame.ModBase(attr, val);
+}
+
+void
+PlayerAVOModCurrent(
+    UInt32 unk1,
+    ActorAttribute::t attr,
+    float val
+) {
+    (void)unk1;
+    fakeGame.ModCurrent(attr, val);
+}
+
+extern "C" void
+ImprovePlayerSkillPoints_Original(
+    void *skill_data,
+    ActorAttribute::t skill,
+    float exp,
+    UInt64 unk1,
+    UInt32 unk2,
+    UInt8 unk3,
+    bool unk4
+) {
+    (void)skill_data;
+    (void)unk1;
+    (void)unk2;
+    (void)unk3;
+    (void)unk4;
+    fakeGame.ImproveSkill(skill, exp);
+}
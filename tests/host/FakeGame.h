@@ -0,0 +1,108 @@
+/**
+ * @file FakeGame.h
+ * @author Andrew Spaulding (Kasplat)
+ * @brief A stand-in for the game, which implements the functions in RelocFn.h
+ *        and calls the hooks where the patched game would.
+ * @bug Only the player is modelled, and every patch is assumed to be
+ *      installed.
+ */
+
+#ifndef __SKYRIM_UNCAPPER_AE_TESTS_FAKE_GAME_H__
+#define __SKYRIM_UNCAPPER_AE_TESTS_FAKE_GAME_H__
+
+#include <cstdint>
+#include <vector>
+
+#include "ActorAttribute.h"
+#include "SkillSlot.h"
+
+/*
+ * The hooks which the game reaches through the wrappers in HookWrappers.asm.
+ * The host build calls them directly, as it has no wrappers.
+ */
+extern "C" float GetSkillCap_Hook(ActorAttribute::t skill);
+extern "C" float CalculateChargePointsPerUse_Hook(void *player_av, float base_points,
+                                                  float max_charge);
+extern "C" UInt8 ModifyPerkPool_Hook(UInt8 points, SInt8 count);
+extern "C" float ImproveLevelExpBySkillLevel_Hook(float exp, ActorAttribute::t attr);
+extern "C" void LegendaryResetSkillLevel_Hook(float base_level);
+extern "C" bool CheckConditionForLegendarySkill_Hook(void *player_actor, ActorAttribute::t skill);
+extern "C" bool HideLegendaryButton_Hook(void *player_actor, ActorAttribute::t skill);
+
+/**
+ * @brief Models the player's actor values, level and the game settings.
+ *
+ * Skill exp and level exp follow the vanilla formulas in Vanilla.h. Each
+ * method which stands for something the player does goes through the same
+ * hooks the patched game would call, and counts the calls it makes.
+ */
+class FakeGame {
+  public:
+    /// @brief The number of times the game called each hook.
+    struct HookCounts {
+        uint64_t skillCap;
+        uint64_t chargePoints;
+        uint64_t getCurrent;
+        uint64_t improveSkill;
+        uint64_t perkPool;
+        uint64_t levelExp;
+        uint64_t attributes;
+        uint64_t legendaryReset;
+        uint64_t legendaryCheck;
+        uint64_t legendaryButton;
+    };
+
+  private:
+    /// @brief The number of attribute IDs, which the game may ask about any
+    ///        of through the hooks.
+    static const size_t kAttributeCount = 256;
+
+    float base[kAttributeCount];
+    float modifier[kAttributeCount];
+    float skillExp[SkillSlot::kCount];
+    std::vector<float> gameSettings;
+
+    UInt16 level;
+    float levelExp;
+    UInt8 perkPoints;
+
+    /// @brief Whether the game's original functions only remember the values
+    ///        the hooks give them.
+    bool passive;
+    float passedExp;
+
+    HookCounts counts;
+
+  public:
+    FakeGame();
+
+    void Reset(void);
+
+    float *GetFloatSetting(const char *name);
+    inline UInt16 GetLevel(void) const { return level; }
+    inline UInt8 GetPerkPoints(void) const { return perkPoints; }
+    inline float GetBase(ActorAttribute::t attr) const { return base[attr]; }
+    inline float GetCurrent(ActorAttribute::t attr) const { return base[attr] + modifier[attr]; }
+    inline void SetLevel(UInt16 val) { level = val; }
+    inline void SetBase(ActorAttribute::t attr, float val) { base[attr] = val; }
+    inline void ModBase(ActorAttribute::t attr, float val) { base[attr] += val; }
+    inline void ModCurrent(ActorAttribute::t attr, float val) { modifier[attr] += val; }
+    inline void SetModifier(ActorAttribute::t attr, float val) { modifier[attr] = val; }
+    inline void SetPassive(bool val) { passive = val; }
+    inline float GetPassedExp(void) const { return passedExp; }
+    inline const HookCounts &GetHookCounts(void) const { return counts; }
+
+    void ImproveSkill(ActorAttribute::t attr, float exp);
+
+    void UseSkill(SkillSlot::t slot, float exp);
+    float GetFormulaLevel(SkillSlot::t slot);
+    float GetChargePointsPerUse(float base_points, float max_charge);
+    bool CanLevelUp(void) const;
+    void LevelUp(ActorAttribute::t choice);
+    bool ShowsLegendaryButton(SkillSlot::t slot);
+    bool MakeLegendary(SkillSlot::t slot);
+};
+
+extern FakeGame fakeGame;
+
+#endif /* __SKYRIM_UNCAPPER_AE_TESTS_FAKE_GAME_H__ */
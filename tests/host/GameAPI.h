@@ -0,0 +1,12 @@
+/**
+ * @file GameAPI.h
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Host stand-in for the SKSE header of the same name. The hooks only
+ *        include it, and use nothing from it.
+ * @bug No known bugs.
+ */
+
+#ifndef __SKYRIM_UNCAPPER_AE_TESTS_GAME_API_H__
+#define __SKYRIM_UNCAPPER_AE_TESTS_GAME_API_H__
+
+#endif /* __SKYRIM_UNCAPPER_AE_TESTS_GAME_API_H__ */
@@ -0,0 +1,14 @@
+/**
+ * @file GameFormComponents.h
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Host stand-in for the SKSE form components header.
+ * @bug No known bugs.
+ */
+
+#ifndef __SKYRIM_UNCAPPER_AE_TESTS_GAME_FORM_COMPONENTS_H__
+#define __SKYRIM_UNCAPPER_AE_TESTS_GAME_FORM_COMPONENTS_H__
+
+/// @brief The skill data of the player, which the hooks only pass along.
+struct PlayerSkills;
+
+#endif /* __SKYRIM_UNCAPPER_AE_TESTS_GAME_FORM_COMPONENTS_H__ */
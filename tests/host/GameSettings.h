@@ -0,0 +1,12 @@
+/**
+ * @file GameSettings.h
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Host stand-in for the SKSE game settings header. The fake game hands
+ *        out game settings as plain floats, so nothing is needed from it.
+ * @bug No known bugs.
+ */
+
+#ifndef __SKYRIM_UNCAPPER_AE_TESTS_GAME_SETTINGS_H__
+#define __SKYRIM_UNCAPPER_AE_TESTS_GAME_SETTINGS_H__
+
+#endif /* __SKYRIM_UNCAPPER_AE_TESTS_GAME_SETTINGS_H__ */
@@ -0,0 +1,21 @@
+/**
+ * @file HostSettingsWatcher.cpp
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Host stand-in for the INI watcher in SettingsWatcher.cpp.
+ *
+ * The watcher is built on Windows file notifications, so the host build starts
+ * no thread, and the tests call SettingsStore::Reload() themselves.
+ *
+ * @bug No known bugs.
+ */
+
+#include "SettingsStore.h"
+
+/**
+ * @brief Starts watching the INI file, which the host leaves to the caller.
+ * @return True, as there is nothing to start.
+ */
+bool
+SettingsStore::StartWatcher() {
+    return true;
+}
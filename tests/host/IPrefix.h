@@ -0,0 +1,59 @@
+/**
+ * @file IPrefix.h
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Host stand-in for the SKSE common prefix header, which the plugin
+ *        force includes in every file.
+ * @bug No known bugs.
+ */
+
+#ifndef __SKYRIM_UNCAPPER_AE_TESTS_IPREFIX_H__
+#define __SKYRIM_UNCAPPER_AE_TESTS_IPREFIX_H__
+
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <strings.h>
+
+typedef uint8_t UInt8;
+typedef uint16_t UInt16;
+typedef uint32_t UInt32;
+typedef uint64_t UInt64;
+typedef int8_t SInt8;
+typedef int16_t SInt16;
+typedef int32_t SInt32;
+typedef int64_t SInt64;
+
+/*
+ * Unlike the plugin, the host build always checks its assertions, as that is
+ * the point of running the tests. Messages are dropped, but warnings and
+ * errors are printed, so that a test which causes one is easy to spot.
+ */
+#define ASSERT(x)\
+    ((x) ? (void)0 : (fprintf(stderr, "%s:%d: ASSERT(%s) failed\n", __FILE__, __LINE__, #x), abort()))
+#define HALT(msg) (fprintf(stderr, "%s:%d: HALT: %s\n", __FILE__, __LINE__, msg), abort())
+
+#define _MESSAGE(...) ((void)0)
+#define _DMESSAGE(...) ((void)0)
+#define _WARNING(...) (fprintf(stderr, "warning: "), fprintf(stderr, __VA_ARGS__), fputc('\n', stderr))
+#define _ERROR(...) (fprintf(stderr, "error: "), fprintf(stderr, __VA_ARGS__), fputc('\n', stderr))
+
+#define _strnicmp strncasecmp
+#define _stricmp strcasecmp
+
+template <size_t N>
+inline int
+sprintf_s(
+    char (&buf)[N],
+    const char *fmt,
+    ...
+) {
+    va_list args;
+    va_start(args, fmt);
+    int ret = vsnprintf(buf, N, fmt, args);
+    va_end(args);
+    return ret;
+}
+
+#endif /* __SKYRIM_UNCAPPER_AE_TESTS_IPREFIX_H__ */
@@ -0,0 +1,9 @@
+/**
+ * @file Ini.h
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Lets the plugin's includes of Ini.h find ini.h on case sensitive
+ *        file systems.
+ * @bug No known bugs.
+ */
+
+#include "../../ini.h"
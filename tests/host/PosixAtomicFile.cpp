@@ -0,0 +1,44 @@
+/**
+ * @file PosixAtomicFile.cpp
+ * @author Andrew Spaulding (Kasplat)
+ * @brief POSIX implementation of atomic file writes, for the host build.
+ * @bug No known bugs.
+ */
+
+#include "AtomicFile.h"
+
+#include <cstdio>
+
+/**
+ * @brief Writes the given data to a file, replacing anything already there.
+ *
+ * The data is written to a temporary file, and then renamed into place, so a
+ * partially written file is never seen.
+ *
+ * @param path The path of the file.
+ * @param data The new contents of the file.
+ * @param size The size of the new contents.
+ * @return True if the file was written.
+ */
+bool
+WriteFileAtomic(
+    const std::string &path,
+    const char *data,
+    size_t size
+) {
+    std::string tmp = path + ".tmp";
+    FILE *f = fopen(tmp.c_str(), "wb");
+    if (!f) {
+        return false;
+    }
+
+    bool ok = (fwrite(data, 1, size, f) == size);
+    ok = (fclose(f) == 0) && ok;
+
+    if (!ok || rename(tmp.c_str(), path.c_str())) {
+        remove(tmp.c_str());
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,76 @@
+/**
+ * @file PosixMappedFile.cpp
+ * @author Andrew Spaulding (Kasplat)
+ * @brief POSIX implementation of read-only file mappings, for the host build.
+ * @bug No known bugs.
+ */
+
+#include "MappedFile.h"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief Maps the file at the given path into memory.
+ *
+ * Any file which was previously opened is closed first. The mapping outlives
+ * the descriptor, so the file is closed as soon as it is mapped.
+ *
+ * @param path The path of the file to map.
+ * @return Ok on success, NotFound if the file does not exist, or Failed.
+ */
+MappedFile::Status
+MappedFile::Open(
+    const char *path
+) {
+    Close();
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return (errno == ENOENT) ? NotFound : Failed;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st)) {
+        close(fd);
+        return Failed;
+    }
+    modified = static_cast<uint64_t>(st.st_mtim.tv_sec) * 1000000000
+             + static_cast<uint64_t>(st.st_mtim.tv_nsec);
+
+    // Empty files can't be mapped, but there's nothing to read anyway.
+    if (st.st_size == 0) {
+        close(fd);
+        return Ok;
+    }
+
+    void *view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) {
+        modified = 0;
+        return Failed;
+    }
+
+    data = static_cast<const char*>(view);
+    size = static_cast<size_t>(st.st_size);
+    return Ok;
+}
+
+/**
+ * @brief Unmaps the file, if one is open.
+ */
+void
+MappedFile::Close() {
+    if (data) {
+        munmap(const_cast<char*>(data), size);
+    }
+
+    file = nullptr;
+    mapping = nullptr;
+    data = nullptr;
+    size = 0;
+    modified = 0;
+}
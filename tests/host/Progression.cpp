@@ -0,0 +1,199 @@
+/**
+ * @file Progression.cpp
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Implementation of the simulated character progression.
+ * @bug No known bugs.
+ */
+
+#include "Progression.h"
+
+#include <cmath>
+#include <vector>
+
+#include "Vanilla.h"
+
+/// @brief The skill cap of the vanilla game, used when the cap patch is off.
+static const float kVanillaSkillCap = 100.0f;
+
+/// @brief The attribute gain of the vanilla game for the chosen attribute.
+static const float kVanillaAttributeGain = 10.0f;
+
+/// @brief The carry weight gain of the vanilla game for choosing stamina.
+static const float kVanillaCarryWeightGain = 5.0f;
+
+/// @brief The attributes a character can choose at a level up.
+static const ActorAttribute::t kChoices[] = {
+    ActorAttribute::Health,
+    ActorAttribute::Magicka,
+    ActorAttribute::Stamina
+};
+
+/**
+ * @brief Draws a random playstyle.
+ */
+Playstyle::Playstyle(
+    std::mt19937 &rng,
+    bool legendary
+) : actionDist(0.5f, 1.5f),
+    legendary(legendary)
+{
+    std::uniform_real_distribution<float> unit_dist(0.0f, 1.0f);
+
+    std::vector<float> skill_prefs;
+    for (size_t i = 0; i < SkillSlot::kCount; i++) {
+        skill_prefs.push_back(std::pow(unit_dist(rng), 4.0f) + 0.01f);
+    }
+    skillDist = std::discrete_distribution<unsigned int>(skill_prefs.begin(), skill_prefs.end());
+
+    float health_pref = unit_dist(rng), magicka_pref = unit_dist(rng), stamina_pref = unit_dist(rng);
+    choiceDist = std::discrete_distribution<unsigned int>({ health_pref, magicka_pref, stamina_pref });
+}
+
+/**
+ * @brief Picks the skill the character uses next.
+ */
+SkillSlot::t
+Playstyle::NextSkill(
+    std::mt19937 &rng
+) {
+    return static_cast<SkillSlot::t>(skillDist(rng));
+}
+
+/**
+ * @brief Gets the exp of the character's next action with a skill, before
+ *        any multiplier.
+ */
+float
+Playstyle::NextExp(
+    SkillSlot::t slot,
+    std::mt19937 &rng
+) {
+    return VanillaActionExp(kVanillaSkills[slot]) * actionDist(rng);
+}
+
+/**
+ * @brief Picks the attribute the character raises at their next level up.
+ */
+ActorAttribute::t
+Playstyle::NextChoice(
+    std::mt19937 &rng
+) {
+    return kChoices[choiceDist(rng)];
+}
+
+/**
+ * @brief Sets up a new character.
+ */
+void
+StartCharacter(
+    Character &c
+) {
+    for (size_t i = 0; i < SkillSlot::kCount; i++) {
+        c.skills[i] = kVanillaStartSkillLevel;
+        c.skillExp[i] = 0;
+    }
+    c.level = 1;
+    c.levelExp = 0;
+    c.perks = 0;
+    c.attributes = {
+        kVanillaStartAttribute,
+        kVanillaStartAttribute,
+        kVanillaStartAttribute,
+        kVanillaStartCarryWeight
+    };
+}
+
+/**
+ * @brief Levels up a character, who picked the given attribute.
+ */
+void
+LevelUp(
+    Character &c,
+    ActorAttribute::t choice
+) {
+    c.levelExp -= VanillaLevelThreshold(c.level);
+    c.level++;
+
+    c.perks += settings.IsPerkPointsEnabled() ? settings.GetPerkDelta(c.level) : 1;
+
+    ActorAttributeLevelUp level_up = { 0, 0, 0, 0 };
+    if (settings.IsAttributePointsEnabled()) {
+        settings.GetAttributeLevelUp(c.level, choice, level_up);
+    } else if (choice == ActorAttribute::Health) {
+        level_up.health = kVanillaAttributeGain;
+    } else if (choice == ActorAttribute::Magicka) {
+        level_up.magicka = kVanillaAttributeGain;
+    } else {
+        level_up.stamina = kVanillaAttributeGain;
+        level_up.carry_weight = kVanillaCarryWeightGain;
+    }
+
+    c.attributes.health += level_up.health;
+    c.attributes.magicka += level_up.magicka;
+    c.attributes.stamina += level_up.stamina;
+    c.attributes.carry_weight += level_up.carry_weight;
+}
+
+/**
+ * @brief Gives exp to a skill, and raises its level and the player's level
+ *        exp as the game would with the hooks installed.
+ * @param legendary Whether the player makes the skill legendary once it can
+ *                  go no higher.
+ * @param scales Multiplies the exp multipliers of the settings. Only applied
+ *               where the settings apply them.
+ */
+void
+ImproveSkill(
+    Character &c,
+    SkillSlot::t slot,
+    float exp,
+    bool legendary,
+    const ExpScales &scales
+) {
+    ActorAttribute::t attr = VanillaSkillAttribute(slot);
+    const VanillaSkill &skill = kVanillaSkills[slot];
+    float &base = c.skills[slot];
+
+    if (settings.IsSkillExpEnabled()) {
+        exp *= settings.GetSkillExpGainMult(
+            attr,
+            static_cast<unsigned int>(base),
+            c.level
+        ) * scales.skillExp;
+    }
+
+    float cap = settings.IsSkillCapEnabled() ? settings.GetSkillCap(attr) : kVanillaSkillCap;
+    c.skillExp[slot] += exp;
+    while (base < cap) {
+        float threshold = VanillaSkillThreshold(skill, base);
+        if (c.skillExp[slot] < threshold) {
+            break;
+        }
+
+        c.skillExp[slot] -= threshold;
+        base += 1;
+
+        float level_exp = kVanillaExpPerSkillRank * base;
+        if (settings.IsLevelExpEnabled()) {
+            level_exp *= settings.GetLevelSkillExpMult(
+                attr,
+                static_cast<unsigned int>(base),
+                c.level
+            ) * scales.levelExp;
+        }
+        c.levelExp += level_exp;
+    }
+
+    if (base >= cap) {
+        c.skillExp[slot] = 0;
+
+        bool available = settings.IsLegendaryEnabled()
+            ? settings.IsLegendaryAvailable(static_cast<unsigned int>(base))
+            : (base >= kVanillaSkillCap);
+        if (legendary && available) {
+            base = settings.IsLegendaryEnabled()
+                ? settings.GetPostLegendarySkillLevel(kVanillaStartSkillLevel, base)
+                : kVanillaStartSkillLevel;
+        }
+    }
+}
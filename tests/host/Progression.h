@@ -0,0 +1,64 @@
+/**
+ * @file Progression.h
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Plays a simulated character through skill uses and level ups, with
+ *        the loaded settings applied the way the hooks apply them.
+ * @bug No known bugs.
+ */
+
+#ifndef __SKYRIM_UNCAPPER_AE_TESTS_PROGRESSION_H__
+#define __SKYRIM_UNCAPPER_AE_TESTS_PROGRESSION_H__
+
+#include <random>
+
+#include "Settings.h"
+
+/// @brief The state of one simulated character.
+struct Character {
+    float skills[SkillSlot::kCount];
+    float skillExp[SkillSlot::kCount];
+    unsigned int level;
+    float levelExp;
+    unsigned int perks;
+    ActorAttributeLevelUp attributes;
+};
+
+/**
+ * @brief Multipliers applied on top of the top level exp multipliers of the
+ *        settings, so that a change to them can be tried without reloading.
+ */
+struct ExpScales {
+    float skillExp;
+    float levelExp;
+};
+
+/// @brief Leaves the settings as they are.
+static const ExpScales kNoExpScales = { 1.0f, 1.0f };
+
+/**
+ * @brief The random mix of skills and attributes a character favours.
+ *
+ * Most characters focus on a few skills, so the preferences are skewed.
+ */
+class Playstyle {
+  private:
+    std::uniform_real_distribution<float> actionDist;
+    std::discrete_distribution<unsigned int> skillDist;
+    std::discrete_distribution<unsigned int> choiceDist;
+
+  public:
+    /// @brief Whether the character makes capped skills legendary.
+    bool legendary;
+
+    Playstyle(std::mt19937 &rng, bool legendary);
+
+    SkillSlot::t NextSkill(std::mt19937 &rng);
+    float NextExp(SkillSlot::t slot, std::mt19937 &rng);
+    ActorAttribute::t NextChoice(std::mt19937 &rng);
+};
+
+void StartCharacter(Character &c);
+void LevelUp(Character &c, ActorAttribute::t choice);
+void ImproveSkill(Character &c, SkillSlot::t slot, float exp, bool legendary, const ExpScales &scales);
+
+#endif /* __SKYRIM_UNCAPPER_AE_TESTS_PROGRESSION_H__ */
@@ -0,0 +1,51 @@
+/**
+ * @file TestFiles.h
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Helpers for the host tests which read and write whole files.
+ * @bug No known bugs.
+ */
+
+#ifndef __SKYRIM_UNCAPPER_AE_TESTS_TEST_FILES_H__
+#define __SKYRIM_UNCAPPER_AE_TESTS_TEST_FILES_H__
+
+#include <cstdio>
+#include <string>
+
+/**
+ * @brief Replaces the given file with the given text, and removes the settings
+ *        cache next to it so that it is read fresh.
+ */
+inline void
+WriteTestFile(
+    const std::string &path,
+    const std::string &text
+) {
+    FILE *f = fopen(path.c_str(), "wb");
+    ASSERT(f);
+    ASSERT(fwrite(text.data(), 1, text.size(), f) == text.size());
+    fclose(f);
+    remove((path + ".cache").c_str());
+}
+
+/**
+ * @brief Reads the whole of the given file.
+ */
+inline std::string
+ReadTestFile(
+    const std::string &path
+) {
+    std::string text;
+    FILE *f = fopen(path.c_str(), "rb");
+    ASSERT(f);
+
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        text.append(buf, n);
+    }
+
+    fclose(f);
+    return text;
+}
+
+#endif /* __SKYRIM_UNCAPPER_AE_TESTS_TEST_FILES_H__ */
@@ -0,0 +1,190 @@
+/**
+ * @file TraceReplay.cpp
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Implementation of hook trace replay.
+ * @bug No known bugs.
+ */
+
+#include "TraceReplay.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "Hook_Skill.h"
+#include "FakeGame.h"
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * @brief Sets up the fake game as the hook saw the game in a record, calls
+ *        the hook, and fills in the values as the hook would record them.
+ * @param rec The record to replay.
+ * @param got Returns the inputs of the record, followed by the new results.
+ * @param ns Returns the time spent in the hook.
+ * @return False if the record names no known hook.
+ */
+static bool
+ReplayRecord(
+    const HookTraceRecord &rec,
+    float (&got)[5],
+    double &ns
+) {
+    ActorAttribute::t attr = static_cast<ActorAttribute::t>(rec.attr);
+    const float *in = rec.values;
+    memcpy(got, rec.values, sizeof(got));
+
+    fakeGame.SetLevel(rec.level);
+    Clock::time_point start;
+    switch (rec.hook) {
+        case HookTrace::SkillCap:
+            start = Clock::now();
+            got[0] = GetSkillCap_Hook(attr);
+            break;
+        case HookTrace::ChargeSettings:
+            *fakeGame.GetFloatSetting("fEnchantingCostExponent") = in[0];
+            *fakeGame.GetFloatSetting("fEnchantingSkillCostBase") = in[1];
+            *fakeGame.GetFloatSetting("fEnchantingSkillCostScale") = in[2];
+            *fakeGame.GetFloatSetting("fEnchantingSkillCostMult") = in[3];
+            start = Clock::now();
+            break;
+        case HookTrace::ChargePoints:
+            fakeGame.SetBase(ActorAttribute::Enchanting, in[2]);
+            fakeGame.SetModifier(ActorAttribute::Enchanting, 0);
+            start = Clock::now();
+            got[3] = CalculateChargePointsPerUse_Hook(&fakeGame, in[0], in[1]);
+            break;
+        case HookTrace::GetCurrent:
+            fakeGame.SetBase(attr, in[0]);
+            fakeGame.SetModifier(attr, 0);
+            start = Clock::now();
+            got[1] = PlayerAVOGetCurrent_Hook(&fakeGame, attr);
+            break;
+        case HookTrace::ImproveSkill:
+            fakeGame.SetBase(attr, in[1]);
+            start = Clock::now();
+            ImprovePlayerSkillPoints_Hook(nullptr, attr, in[0], 0, 0, 0, false);
+            got[2] = fakeGame.GetPassedExp();
+            break;
+        case HookTrace::PerkPool:
+            start = Clock::now();
+            got[2] = ModifyPerkPool_Hook(static_cast<UInt8>(in[0]), static_cast<SInt8>(in[1]));
+            break;
+        case HookTrace::LevelExp:
+            fakeGame.SetBase(attr, in[1]);
+            start = Clock::now();
+            got[2] = ImproveLevelExpBySkillLevel_Hook(in[0], attr);
+            break;
+        case HookTrace::Attributes:
+            // The gains are added to zero, so they come out exactly.
+            fakeGame.SetBase(ActorAttribute::Health, 0);
+            fakeGame.SetBase(ActorAttribute::Magicka, 0);
+            fakeGame.SetBase(ActorAttribute::Stamina, 0);
+            fakeGame.SetBase(ActorAttribute::CarryWeight, 0);
+            fakeGame.SetModifier(ActorAttribute::CarryWeight, 0);
+            start = Clock::now();
+            ImproveAttributeWhenLevelUp_Hook(&fakeGame, attr);
+            got[0] = fakeGame.GetBase(ActorAttribute::Health);
+            got[1] = fakeGame.GetBase(ActorAttribute::Magicka);
+            got[2] = fakeGame.GetBase(ActorAttribute::Stamina);
+            got[3] = fakeGame.GetCurrent(ActorAttribute::CarryWeight);
+            break;
+        case HookTrace::LegendaryReset:
+            *fakeGame.GetFloatSetting("fLegendarySkillResetValue") = in[0];
+            start = Clock::now();
+            LegendaryResetSkillLevel_Hook(in[1]);
+            got[2] = *fakeGame.GetFloatSetting("fLegendarySkillResetValue");
+            break;
+        case HookTrace::LegendaryCheck:
+            fakeGame.SetBase(attr, in[0]);
+            start = Clock::now();
+            got[1] = CheckConditionForLegendarySkill_Hook(&fakeGame, attr) ? 1.0f : 0.0f;
+            break;
+        case HookTrace::LegendaryButton:
+            fakeGame.SetBase(attr, in[0]);
+            start = Clock::now();
+            got[1] = HideLegendaryButton_Hook(&fakeGame, attr) ? 1.0f : 0.0f;
+            break;
+        default:
+            return false;
+    }
+
+    ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    return true;
+}
+
+/**
+ * @brief Prints a divergent record, and what the hook gave this time.
+ */
+static void
+PrintDivergence(
+    const HookTraceRecord &rec,
+    const float (&got)[5]
+) {
+    printf("divergence: %s attr %u level %u\n  trace:",
+           HookTrace::Str(static_cast<HookTrace::Hook>(rec.hook)), rec.attr, rec.level);
+    for (float val : rec.values) {
+        printf(" %.9g", val);
+    }
+
+    printf("\n  now:  ");
+    for (float val : got) {
+        printf(" %.9g", val);
+    }
+
+    printf("\n");
+}
+
+/**
+ * @brief Replays every record of a trace file through the hooks.
+ *
+ * The hooks use the current settings, and a result which differs from the
+ * trace in any bit is a divergence. The fake game is left passive, with the
+ * state of the last record.
+ *
+ * @param path The path of the trace file.
+ * @param max_reports The most divergences to print.
+ * @param stats Returns the calls, divergences and time of each hook.
+ * @return True if the whole trace was replayed.
+ */
+bool
+ReplayTrace(
+    const std::string &path,
+    unsigned int max_reports,
+    ReplayStats &stats
+) {
+    memset(&stats, 0, sizeof(stats));
+
+    HookTraceReader reader;
+    if (!reader.Open(path)) {
+        stats.failed = true;
+        return false;
+    }
+
+    fakeGame.Reset();
+    fakeGame.SetPassive(true);
+
+    HookTraceRecord rec;
+    unsigned int reports = 0;
+    while (reader.Next(rec)) {
+        float got[5];
+        double ns;
+        if (!ReplayRecord(rec, got, ns)) {
+            stats.failed = true;
+            break;
+        }
+
+        stats.calls[rec.hook]++;
+        stats.ns[rec.hook] += ns;
+        if (memcmp(got, rec.values, sizeof(got))) {
+            stats.divergences[rec.hook]++;
+            if (reports++ < max_reports) {
+                PrintDivergence(rec, got);
+            }
+        }
+    }
+
+    stats.dropped = reader.Dropped();
+    stats.failed |= reader.Failed();
+    return !stats.failed;
+}
@@ -0,0 +1,36 @@
+/**
+ * @file TraceReplay.h
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Replays a hook trace through the hooks against the fake game, and
+ *        compares each result with the recorded one.
+ * @bug No known bugs.
+ */
+
+#ifndef __SKYRIM_UNCAPPER_AE_TESTS_TRACE_REPLAY_H__
+#define __SKYRIM_UNCAPPER_AE_TESTS_TRACE_REPLAY_H__
+
+#include <cstdint>
+#include <string>
+
+#include "HookTrace.h"
+
+/// @brief The calls, divergences and time of each hook in a replayed trace.
+struct ReplayStats {
+    uint64_t calls[HookTrace::kHookCount];
+
+    /// @brief The calls whose results differed in any bit from the trace.
+    uint64_t divergences[HookTrace::kHookCount];
+
+    /// @brief The time spent in each hook, in nanoseconds.
+    double ns[HookTrace::kHookCount];
+
+    /// @brief The records which were dropped while the trace was recorded.
+    uint64_t dropped;
+
+    /// @brief Whether the trace was cut short or corrupt.
+    bool failed;
+};
+
+bool ReplayTrace(const std::string &path, unsigned int max_reports, ReplayStats &stats);
+
+#endif /* __SKYRIM_UNCAPPER_AE_TESTS_TRACE_REPLAY_H__ */
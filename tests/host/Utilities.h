@@ -0,0 +1,7 @@
+/**
+ * @file Utilities.h
+ * @author Andrew Spaulding (Kasplat)
+ * @brief Host stand-in for the SKSE utilities header. Nothing the host build
+ *        compiles uses it.
+ * @bug No known bugs.
+ */
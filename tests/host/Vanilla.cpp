@@ -0,0 +1,43 @@
+/**
+ * @file Vanilla.cpp
+ * @author Andrew Spaulding (Kasplat)
+ * @brief The vanilla progression constants.
+ * @bug No known bugs.
+ */
+
+#include "Vanilla.h"
+
+const VanillaGameSetting kVanillaGameSettings[] = {
+    { "fEnchantingCostExponent", 1.1f },
+    { "fEnchantingSkillCostBase", 0.005f },
+    { "fEnchantingSkillCostScale", 0.5f },
+    { "fEnchantingSkillCostMult", 3.0f },
+    { "fLegendarySkillResetValue", 15.0f },
+    { "fSkillUseCurve", kVanillaSkillUseCurve },
+    { "fXPLevelUpBase", kVanillaLevelUpBase },
+    { "fXPLevelUpMult", kVanillaLevelUpMult },
+    { "fXPPerSkillRank", kVanillaExpPerSkillRank },
+    { nullptr, 0 }
+};
+
+// Indexed by SkillSlot.
+const VanillaSkill kVanillaSkills[SkillSlot::kCount] = {
+    { 6.3f, 0.0f, 2.0f, 0.0f, 12.0f },     // OneHanded
+    { 5.95f, 0.0f, 2.0f, 0.0f, 18.0f },    // TwoHanded
+    { 9.3f, 0.0f, 2.0f, 0.0f, 12.0f },     // Marksman
+    { 8.1f, 0.0f, 2.0f, 0.0f, 8.0f },      // Block
+    { 0.25f, 0.0f, 0.25f, 300.0f, 60.0f }, // Smithing
+    { 3.8f, 0.0f, 2.0f, 0.0f, 10.0f },     // HeavyArmor
+    { 4.0f, 0.0f, 2.0f, 0.0f, 10.0f },     // LightArmor
+    { 8.1f, 0.0f, 0.25f, 250.0f, 20.0f },  // Pickpocket
+    { 45.0f, 10.0f, 0.25f, 300.0f, 1.0f }, // LockPicking
+    { 11.25f, 0.0f, 0.5f, 120.0f, 2.0f },  // Sneak
+    { 0.75f, 0.0f, 1.6f, 65.0f, 40.0f },   // Alchemy
+    { 0.36f, 0.0f, 2.0f, 0.0f, 100.0f },   // SpeechCraft
+    { 3.0f, 0.0f, 2.0f, 0.0f, 10.0f },     // Alteration
+    { 2.1f, 0.0f, 2.0f, 0.0f, 15.0f },     // Conjuration
+    { 1.35f, 0.0f, 2.0f, 0.0f, 25.0f },    // Destruction
+    { 4.6f, 0.0f, 2.0f, 0.0f, 8.0f },      // Illusion
+    { 2.0f, 0.0f, 2.0f, 0.0f, 15.0f },     // Restoration
+    { 900.0f, 0.0f, 1.0f, 170.0f, 1.0f }   // Enchanting
+};
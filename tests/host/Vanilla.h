@@ -0,0 +1,111 @@
+/**
+ * @file Vanilla.h
+ * @author Andrew Spaulding (Kasplat)
+ * @brief The vanilla game's skill and level progression, for the fake game
+ *        and the progression simulator.
+ * @bug The skill constants are approximations of the vanilla actor value
+ *      data, and actions are modelled as a fixed typical value per skill.
+ */
+
+#ifndef __SKYRIM_UNCAPPER_AE_TESTS_VANILLA_H__
+#define __SKYRIM_UNCAPPER_AE_TESTS_VANILLA_H__
+
+#include <cmath>
+
+#include "SkillSlot.h"
+
+/**
+ * @brief The vanilla game settings which the hooks and the progression
+ *        formulas read.
+ */
+struct VanillaGameSetting {
+    const char *name;
+    float value;
+};
+
+/**
+ * @brief How a skill gains exp and levels up in the vanilla game.
+ *
+ * An action of a skill gives useMult * value + useOffset exp. The skill then
+ * needs improveMult * level ^ fSkillUseCurve + improveOffset exp to go up a
+ * level.
+ */
+struct VanillaSkill {
+    float useMult;
+    float useOffset;
+    float improveMult;
+    float improveOffset;
+
+    /// @brief The value of a typical action of the skill, such as the damage
+    ///        of a hit or the gold value of a crafted item.
+    float actionValue;
+};
+
+/// @brief The vanilla game settings, ending with a null name.
+extern const VanillaGameSetting kVanillaGameSettings[];
+
+/// @brief The vanilla progression of each skill.
+extern const VanillaSkill kVanillaSkills[SkillSlot::kCount];
+
+/// @brief The exponent of the skill level curve, fSkillUseCurve.
+static const float kVanillaSkillUseCurve = 1.95f;
+
+/// @brief The base of the player level curve, fXPLevelUpBase.
+static const float kVanillaLevelUpBase = 75.0f;
+
+/// @brief The slope of the player level curve, fXPLevelUpMult.
+static const float kVanillaLevelUpMult = 25.0f;
+
+/// @brief The level exp given per skill level, fXPPerSkillRank.
+static const float kVanillaExpPerSkillRank = 1.0f;
+
+/// @brief The level skills start at for a new character.
+static const float kVanillaStartSkillLevel = 15.0f;
+
+/// @brief The level health, magicka and stamina start at.
+static const float kVanillaStartAttribute = 100.0f;
+
+/// @brief The carry weight a new character starts with.
+static const float kVanillaStartCarryWeight = 300.0f;
+
+/// @brief Converts a skill slot to the attribute the game uses for it.
+inline ActorAttribute::t
+VanillaSkillAttribute(
+    SkillSlot::t slot
+) {
+    return static_cast<ActorAttribute::t>(ActorAttribute::OneHanded + slot);
+}
+
+/**
+ * @brief Gets the exp a typical action of a skill gives, before any
+ *        multiplier.
+ */
+inline float
+VanillaActionExp(
+    const VanillaSkill &skill
+) {
+    return skill.useMult * skill.actionValue + skill.useOffset;
+}
+
+/**
+ * @brief Gets the exp a skill needs to go up from the given level.
+ */
+inline float
+VanillaSkillThreshold(
+    const VanillaSkill &skill,
+    float level
+) {
+    return skill.improveMult * std::pow(level, kVanillaSkillUseCurve) + skill.improveOffset;
+}
+
+/**
+ * @brief Gets the level exp the player needs to go up from the given level.
+ */
+inline float
+VanillaLevelThreshold(
+    unsigned int level
+) {
+    return kVanillaLevelUpBase + kVanillaLevelUpMult * level;
+}
+
+#endif /* __SKYRIM_UNCAPPER_AE_TESTS_VANILLA_H__ */